@@ -0,0 +1,159 @@
+#include "actions.h"
+#include "context.h"
+#include "rules.h"
+#include "lockstep.h"
+#include "simulation.h"
+#include "validation.h"
+#include "engine/utils.h"
+
+// Only used by the validation reports
+static const char* action_names[NUM_ACTIONS] = {
+    [ACTION_MOVE] = "moving",
+    [ACTION_TRAIN] = "training",
+    [ACTION_BUILD_FARM] = "building a farm",
+    [ACTION_FIX_FARM] = "fixing a farm",
+    [ACTION_END_TURN] = "ending the turn",
+};
+
+static bool perform_action(const action_t* action)
+{
+    // Actions might come from the network, so they are not trusted
+    if (action->kind != ACTION_END_TURN && !is_valid_tile(action->tile_x, action->tile_y))
+        return false;
+
+    switch (action->kind)
+    {
+        case ACTION_MOVE:
+            if (!is_valid_tile(action->target_x, action->target_y)) return false;
+
+            return move_soldiers_between(action->tile_x, action->tile_y, action->target_x, action->target_y);
+
+        case ACTION_TRAIN:
+            if (action->choice < 0 || action->choice >= NUM_SOLDIERS) return false;
+
+            return train_soldiers(action->tile_x, action->tile_y, action->choice);
+
+        case ACTION_BUILD_FARM:
+            return build_farm(action->tile_x, action->tile_y);
+
+        case ACTION_FIX_FARM:
+            return fix_farm(action->tile_x, action->tile_y);
+
+        case ACTION_END_TURN:
+            clear_selected_soldiers();
+            next_turn();
+
+            return true;
+
+        default:
+            return false;
+    }
+
+    return false;
+}
+
+bool apply_action(const action_t* action)
+{
+    int player_id = ctx.current_player_id;
+
+    if (!perform_action(action)) return false;
+
+    if (is_validation_enabled)
+    {
+        char description[100];
+
+        if (action->kind == ACTION_MOVE)
+            sprintf(description, "player %d %s from (%d, %d) to (%d, %d)", player_id, action_names[action->kind],
+                action->tile_x, action->tile_y, action->target_x, action->target_y);
+        else if (action->kind == ACTION_END_TURN)
+            sprintf(description, "player %d %s", player_id, action_names[action->kind]);
+        else
+            sprintf(description, "player %d %s at (%d, %d)", player_id, action_names[action->kind], action->tile_x, action->tile_y);
+
+        validate_counters(description);
+    }
+
+    return true;
+}
+
+bool submit_action(const action_t* action)
+{
+    // The other machines are playing right now
+    if (!is_local_turn()) return false;
+
+    // Local games apply it on the simulation thread, the result shows up once the main thread syncs
+    if (is_simulation_running())
+        return queue_action(action);
+
+    unsigned int turn = ctx.turn;
+
+    if (!apply_action(action)) return false;
+
+    // Turn changes are sent along with a checksum so that the others can verify they are in sync
+    send_action(action, ctx.turn != turn);
+
+    // It's already applied, so the next frame shows it
+    if (action->input_time)
+        track_input_latency(&ctx.game, action->input_time);
+
+    return true;
+}
+
+// How many numbers follow the kind byte
+static int get_total_arguments(action_kind_e kind)
+{
+    switch (kind)
+    {
+        case ACTION_MOVE: return 4;
+        case ACTION_TRAIN: return 3;
+        case ACTION_BUILD_FARM:
+        case ACTION_FIX_FARM: return 2;
+        default: return 0;
+    }
+}
+
+int encode_action(const action_t* action, uint8_t* buffer)
+{
+    uint32_t arguments[4] = {action->tile_x, action->tile_y, action->target_x, action->target_y};
+
+    if (action->kind == ACTION_TRAIN)
+        arguments[2] = action->choice;
+
+    int length = 0;
+    buffer[length++] = action->kind;
+
+    for (int i = 0; i < get_total_arguments(action->kind); i++)
+        length += write_varint(buffer + length, arguments[i]);
+
+    return length;
+}
+
+int decode_action(action_t* action, const uint8_t* buffer, int length)
+{
+    if (length < 1) return 0;
+
+    action->kind = buffer[0] & ACTION_KIND_MASK;
+    if (action->kind >= NUM_ACTIONS) return -1;
+
+    uint32_t arguments[4] = {0};
+    int offset = 1;
+
+    for (int i = 0; i < get_total_arguments(action->kind); i++)
+    {
+        int read = read_varint(buffer + offset, length - offset, &arguments[i]);
+
+        if (read == 0)
+            // Varints of tile coordinates never need more than 5 bytes
+            return length - offset >= 5 ? -1 : 0;
+
+        offset += read;
+    }
+
+    action->tile_x = arguments[0];
+    action->tile_y = arguments[1];
+    action->target_x = arguments[2];
+    action->target_y = arguments[3];
+    action->choice = arguments[2];
+
+    return offset;
+}
@@ -0,0 +1,58 @@
+#ifndef _ACTIONS_H
+#define _ACTIONS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Everything a player can do is described by an action
+ * They are tiny, so network games only need to send them around instead of the game state
+ */
+
+typedef enum
+{
+    ACTION_MOVE,
+    ACTION_TRAIN,
+    ACTION_BUILD_FARM,
+    ACTION_FIX_FARM,
+    ACTION_END_TURN,
+
+    NUM_ACTIONS,
+} action_kind_e;
+
+typedef struct
+{
+    action_kind_e kind;
+
+    // Moves go from the tile to the target, everything else only uses the tile
+    int tile_x, tile_y;
+    int target_x, target_y;
+
+    // Used as soldier_kind_e when training
+    int choice;
+
+    // Timestamp of the SDL event of a local player, only used to measure the latency (see track_input_latency)
+    // Zero for everything else, it's never sent over the network
+    uint32_t input_time;
+} action_t;
+
+// The first encoded byte keeps the kind in the low bits, the rest can be used as flags by the caller
+#define ACTION_KIND_MASK 0x0f
+
+// Big enough for any encoded action
+#define MAX_ENCODED_ACTION 24
+
+// Performs the action for the current player, returns false if the rules don't allow it
+bool apply_action(const action_t* action);
+
+// Same as apply_action, but it also shares the action with the other players of a network game
+// When the simulation thread is running it only queues the action (see simulation.h)
+bool submit_action(const action_t* action);
+
+// Returns the amount of written bytes
+int encode_action(const action_t* action, uint8_t* buffer);
+
+// Returns the amount of bytes read, 0 if the action is not complete yet and -1 if the data is invalid
+int decode_action(action_t* action, const uint8_t* buffer, int length);
+
+#endif
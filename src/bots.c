@@ -0,0 +1,318 @@
+#include <limits.h>
+
+#include "context.h"
+#include "bots.h"
+#include "rules.h"
+#include "savestate.h"
+#include "engine/utils.h"
+
+#define MAX_CANDIDATES 2048
+
+// How many of the best greedy candidates the search bot tries out
+#define SEARCH_WIDTH 12
+
+typedef struct
+{
+    action_t action;
+    int score;
+} candidate_t;
+
+int find_bot_kind(const char* name)
+{
+    for (int i = 0; i < NUM_BOTS; i++)
+    {
+        if (strcmp(bot_names[i], name) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+// Every action that might be allowed for the current player, the rules have the final say
+static int collect_candidates(candidate_t* candidates)
+{
+    int total = 0;
+    player_t* player = &ctx.players[ctx.current_player_id];
+
+    MAP_FOREACH(x, y)
+    {
+        if (total + TOTAL_HIGHLIGHTED + 2 > MAX_CANDIDATES) break;
+
+        tile_t* tile = &ctx.tilemap[y][x];
+        if (tile->owner_id != ctx.current_player_id) continue;
+
+        if (tile->kind == TILE_CITY)
+        {
+            for (int kind = 0; kind < NUM_SOLDIERS; kind++)
+            {
+                if (player->coins >= soldier_kinds[kind].cost)
+                    candidates[total++].action = (action_t) {ACTION_TRAIN, x, y, .choice = kind};
+            }
+        }
+        else if (tile->kind == TILE_GRASS && player->coins >= FARM_COST && !tile->soldiers)
+            candidates[total++].action = (action_t) {ACTION_BUILD_FARM, x, y};
+
+        else if (tile->kind == TILE_BROKEN_FARM && player->coins >= FIX_FARM_COST)
+            candidates[total++].action = (action_t) {ACTION_FIX_FARM, x, y};
+
+        if (!tile->soldiers || tile->soldiers->remaining_moves == 0) continue;
+
+        FOREACH_OFFSET(y, TOTAL_HIGHLIGHTED, i)
+        {
+            int target_x = x + highlighted_offsets[i][0];
+            int target_y = y + highlighted_offsets[i][1];
+
+            if (is_valid_tile(target_x, target_y))
+                candidates[total++].action = (action_t) {ACTION_MOVE, x, y, target_x, target_y};
+        }
+    }
+
+    return total;
+}
+
+// Distance in pixels to the closest thing worth conquering: cities we don't own and capitals of players that are still alive
+static int get_target_distance(int tile_x, int tile_y)
+{
+    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
+    int closest = INT_MAX;
+
+    // Only the lists of the neutral cities and of the other players that are alive are looked at, not the whole map
+    for (int owner_id = -1; owner_id < ctx.starting_players; owner_id++)
+    {
+        if (owner_id == ctx.current_player_id) continue;
+        if (owner_id >= 0 && ctx.players[owner_id].is_dead) continue;
+
+        OWNED_CITIES_FOREACH(owner_id, city_id)
+        {
+            tile_t* target = &ctx.tilemap[ctx.cities[city_id].tile_y][ctx.cities[city_id].tile_x];
+            int distance = get_distance(tile->dest_rect.x, tile->dest_rect.y, target->dest_rect.x, target->dest_rect.y);
+
+            if (distance < closest)
+                closest = distance;
+        }
+    }
+
+    return closest;
+}
+
+static int score_move(const action_t* action)
+{
+    soldiers_t* soldiers = ctx.tilemap[action->tile_y][action->tile_x].soldiers;
+    tile_t* target = &ctx.tilemap[action->target_y][action->target_x];
+
+    bool is_saboteur = soldiers->kind == SOLDIER_SABOTEUR;
+
+    // Bots play by the same rules as people, soldiers under the fog are a surprise
+    if (target->soldiers && is_tile_visible(ctx.current_player_id, action->target_x, action->target_y))
+    {
+        // Merging is only useful for gathering bigger armies
+        if (target->owner_id == ctx.current_player_id)
+            return target->soldiers->kind == soldiers->kind && !is_saboteur ? 1 : INT_MIN;
+
+        if (soldiers->units <= target->soldiers->units) return INT_MIN;
+
+        return (target->is_capital ? 1000 : 40) + target->soldiers->units;
+    }
+
+    if (target->owner_id != ctx.current_player_id)
+    {
+        if (target->is_capital && !is_saboteur) return 1000;
+        if (target->kind == TILE_CITY) return is_saboteur ? INT_MIN : 60;
+        if (target->kind == TILE_FARM) return is_saboteur ? 50 : 25;
+
+        return 10;
+    }
+
+    // Walking inside our own land is only worth it when it gets us closer to a city
+    int before = get_target_distance(action->tile_x, action->tile_y);
+    int after = get_target_distance(action->target_x, action->target_y);
+
+    if (before == INT_MAX) return INT_MIN;
+
+    return (before - after) / 10;
+}
+
+static int score_action(const action_t* action)
+{
+    player_t* player = &ctx.players[ctx.current_player_id];
+
+    switch (action->kind)
+    {
+        case ACTION_MOVE:
+            return score_move(action);
+
+        case ACTION_TRAIN:
+            // Keeping some coins around so that the army doesn't bankrupt us
+            if (action->choice == SOLDIER_KNIGHT)
+                return player->coins + 10 * (player->income - COST_PER_10_UNITS) >= 0 ? 15 : INT_MIN;
+
+            return player->coins > 3 * soldier_kinds[SOLDIER_SABOTEUR].cost ? 5 : INT_MIN;
+
+        case ACTION_BUILD_FARM:
+            return 20;
+
+        case ACTION_FIX_FARM:
+            return 30;
+
+        default:
+            return 0;
+    }
+}
+
+// How good the position is for the player, his own value minus the average of the others
+static int evaluate_position(int player_id)
+{
+    if (ctx.players[player_id].is_dead) return INT_MIN / 2;
+    if (find_winner() == player_id) return INT_MAX / 2;
+
+    player_t* player = &ctx.players[player_id];
+
+    int own_value = 3 * player->total_territories + 20 * player->total_cities + 10 * player->total_farms
+        + player->total_units + player->coins / 4 + 4 * calculate_income(player);
+
+    int enemy_value = 0, total_enemies = 0;
+
+    for (int i = 0; i < ctx.starting_players; i++)
+    {
+        if (i != player_id && !ctx.players[i].is_dead)
+            total_enemies++;
+    }
+
+    // Armies standing still never win a game
+    int distance_penalty = 0;
+
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+
+        // The enemies are only judged by the part of them that we can see
+        if (tile->owner_id >= 0 && tile->owner_id != player_id && !ctx.players[tile->owner_id].is_dead
+            && is_tile_visible(player_id, x, y))
+        {
+            enemy_value += 3 + (tile->kind == TILE_CITY ? 20 : 0) + (tile->kind == TILE_FARM ? 10 : 0)
+                + (tile->soldiers ? tile->soldiers->units : 0);
+        }
+
+        if (tile->owner_id != player_id || !tile->soldiers || tile->soldiers->kind != SOLDIER_KNIGHT) continue;
+
+        int distance = get_target_distance(x, y);
+        if (distance != INT_MAX) distance_penalty += distance / 50;
+    }
+
+    if (total_enemies > 0)
+        enemy_value /= total_enemies;
+
+    return own_value - enemy_value - distance_penalty;
+}
+
+static bool play_random_action(candidate_t* candidates, int total, uint32_t* random_state)
+{
+    // Ending the turn is one of the choices
+    for (int attempt = 0; attempt < 8; attempt++)
+    {
+        int choice = next_random(random_state) % (total + 1);
+        if (choice == total) return false;
+
+        if (apply_action(&candidates[choice].action)) return true;
+    }
+
+    return false;
+}
+
+static int compare_candidates(const void* first, const void* second)
+{
+    int first_score = ((const candidate_t*) first)->score;
+    int second_score = ((const candidate_t*) second)->score;
+
+    return (first_score < second_score) - (first_score > second_score);
+}
+
+static bool play_greedy_action(candidate_t* candidates, int total)
+{
+    for (int i = 0; i < total; i++)
+        candidates[i].score = score_action(&candidates[i].action);
+
+    qsort(candidates, total, sizeof(candidate_t), compare_candidates);
+
+    for (int i = 0; i < total && candidates[i].score > 0; i++)
+    {
+        if (apply_action(&candidates[i].action)) return true;
+    }
+
+    return false;
+}
+
+static bool play_search_action(candidate_t* candidates, int total)
+{
+    // Thread local, so that every game of a tournament has its own
+    static _Thread_local savestate_t* state = NULL;
+
+    if (!state)
+        state = malloc(sizeof(savestate_t));
+
+    int player_id = ctx.current_player_id;
+    int best_score = INT_MIN;
+    int best_index = -1;
+
+    // Only looking deeper into the moves that the greedy bot would consider, the rest are mostly noise
+    for (int i = 0; i < total; i++)
+        candidates[i].score = score_action(&candidates[i].action);
+
+    qsort(candidates, total, sizeof(candidate_t), compare_candidates);
+
+    save_state(state);
+
+    for (int i = 0; i < total && i < SEARCH_WIDTH && candidates[i].score > 0; i++)
+    {
+        if (!apply_action(&candidates[i].action)) continue;
+
+        int score = evaluate_position(player_id) + candidates[i].score;
+        load_state(state);
+
+        if (score > best_score)
+        {
+            best_score = score;
+            best_index = i;
+        }
+    }
+
+    // Nothing is better than what we have
+    if (best_index < 0) return false;
+
+    return apply_action(&candidates[best_index].action);
+}
+
+void play_bot_turn(bot_kind_e kind, uint32_t* random_state)
+{
+    static _Thread_local candidate_t candidates[MAX_CANDIDATES];
+    unsigned int turn = ctx.turn;
+
+    // Every action uses a move, so the turn always ends at some point
+    while (ctx.turn == turn && find_winner() < 0)
+    {
+        int total = collect_candidates(candidates);
+        bool has_played = false;
+
+        switch (kind)
+        {
+            case BOT_RANDOM:
+                has_played = play_random_action(candidates, total, random_state);
+                break;
+
+            case BOT_GREEDY:
+                has_played = play_greedy_action(candidates, total);
+                break;
+
+            case BOT_SEARCH:
+                has_played = play_search_action(candidates, total);
+                break;
+
+            default:
+                has_played = false;
+                break;
+        }
+
+        if (!has_played)
+            apply_action(&(action_t) {ACTION_END_TURN});
+    }
+}
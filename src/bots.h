@@ -0,0 +1,31 @@
+#ifndef _BOTS_H
+#define _BOTS_H
+
+#include <stdint.h>
+#include "actions.h"
+
+/*
+ * Computer players, they only use actions so they play by the same rules as everyone else
+ * random: picks any action that is allowed
+ * greedy: a script that scores every action with some rules of thumb
+ * search: tries out every action on a copy of the game and keeps the one that leads to the best position
+ */
+
+typedef enum
+{
+    BOT_RANDOM,
+    BOT_GREEDY,
+    BOT_SEARCH,
+
+    NUM_BOTS,
+} bot_kind_e;
+
+static char bot_names[NUM_BOTS][10] = {"random", "greedy", "search"};
+
+// Returns -1 if there is no bot with that name
+int find_bot_kind(const char* name);
+
+// Plays until the current player's turn ends, random_state is used by the bot's own choices
+void play_bot_turn(bot_kind_e kind, uint32_t* random_state);
+
+#endif
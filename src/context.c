@@ -1,15 +1,36 @@
 #include "context.h"
 
 // Initializing the global variable
+#ifdef THREAD_LOCAL_CONTEXT
+_Thread_local context_t ctx;
+#else
 context_t ctx;
+#endif
 
 #include <SDL2/SDL.h>
-#include <SDL2/SDL_image.h>
+#include "engine/utils.h"
 
 // These functions are some utilities that can only be defined with the context in mind
 // They are usually brief versions of other functionality
 
-SDL_Texture* load_texture(const char* file)
+void set_map_seed(int seed)
 {
-    return IMG_LoadTexture(ctx.game.renderer, file);
+    ctx.map_seed = seed;
+
+    // Tools generate lots of maps with the same context
+    open_simplex_noise_free(ctx.noise_context);
+    open_simplex_noise(seed, &ctx.noise_context);
+
+    // Scrambling the seed a bit, it must be odd because zero would get the generator stuck
+    ctx.random_state = ((uint32_t) seed * 2654435761u) | 1;
+}
+
+int random_range(int max)
+{
+    return next_random(&ctx.random_state) % max;
+}
+
+bool random_chance(int max)
+{
+    return random_range(max) == 0;
 }
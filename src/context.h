@@ -1,41 +1,89 @@
 #ifndef _CONTEXT_H
 #define _CONTEXT_H
 
+// Some of the headers below need it too
+#define TOTAL_PLAYERS 4
+
 #include <stdbool.h>
+#include <stdint.h>
 #include "soldiers.h"
 #include "tile.h"
 #include "engine/game.h"
 #include "engine/sprite.h"
+#include "engine/atlas.h"
+#include "engine/camera.h"
 #include "engine/audio.h"
+#include "engine/effects.h"
 #include "engine/interface.h"
 #include "libs/noise/open-simplex.h"
 #include "hex_utils.h"
+#include "lockstep.h"
+#include "spectator.h"
+#include "map_chunks.h"
+#include "minimap.h"
+#include "events.h"
 
 #define TILE_WIDTH 34
 #define TILE_HEIGHT 32
-#define TOTAL_PLAYERS 4
+
+// Tiles of the same row are this far apart, odd rows are shifted to the right by HEX_ROW_OFFSET
+// Rows are TILE_HEIGHT / 2 apart, so the tiles of a row touch the odd row in between
+#define HEX_COLUMN_SPACING (TILE_WIDTH + 16)
+#define HEX_ROW_OFFSET 25
 
 // Constants that should be configured by the programmer
+// The gameplay ones can also be overridden by the compiler for balancing (e.g. -DFARM_INCOME=5)
+#ifndef KNIGHTS_PER_TRAIN
 #define KNIGHTS_PER_TRAIN 10
+#endif
+#ifndef MAX_UNITS
 #define MAX_UNITS 100
+#endif
+#ifndef FARM_INCOME
 #define FARM_INCOME 4
+#endif
+#ifndef CITY_INCOME
 #define CITY_INCOME 1
+#endif
+#ifndef FISH_INCOME
 #define FISH_INCOME 10
+#endif
+#ifndef STARTING_COINS
 #define STARTING_COINS 20
+#endif
+#ifndef MOVES_PER_TURN
 #define MOVES_PER_TURN 6
+#endif
 #define CITY_PREVIEW_OFFSET_X 1
 #define CITY_PREVIEW_OFFSET_Y 2
 
 // How much will units cost per turn
+#ifndef COST_PER_10_UNITS
 #define COST_PER_10_UNITS 2
+#endif
+#ifndef FARM_COST
 #define FARM_COST 35
+#endif
+#ifndef FIX_FARM_COST
 #define FIX_FARM_COST 5
+#endif
 
 // For every TERRITORIES_PER_COIN captured tiles, the player receives one coin
+#ifndef TERRITORIES_PER_COIN
 #define TERRITORIES_PER_COIN 25
+#endif
 
+// The benchmarks also build the game with other map sizes (see make bench)
+#ifndef TILEMAP_WIDTH
 #define TILEMAP_WIDTH 20
-#define TILEMAP_HEIGHT 34 
+#endif
+#ifndef TILEMAP_HEIGHT
+#define TILEMAP_HEIGHT 34
+#endif
+
+// The fog counts sight per tile, so it needs the map size
+#include "fog.h"
+
 #define PANEL_WIDTH 220
 #define PANEL_PADDING 20
 
@@ -43,11 +91,20 @@
 #define FOREST_START 0.3
 #define LAND_START -0.3
 
-// It's ok if it's a bit more than the real value
-#define TOTAL_LABELS 3 * TILEMAP_HEIGHT
+// generate_unclaimed_cities places at most one city per 3x5 chunk, plus the capitals
+#define MAX_CITIES ((TILEMAP_WIDTH / 3 + 1) * (TILEMAP_HEIGHT / 5 + 1) + TOTAL_PLAYERS)
+
+// Cities are bucketed in cells of tiles so that hovering only looks at the cities near the cursor
+#define CITY_GRID_CELL 4
+#define CITY_GRID_WIDTH ((TILEMAP_WIDTH + CITY_GRID_CELL - 1) / CITY_GRID_CELL)
+#define CITY_GRID_HEIGHT ((TILEMAP_HEIGHT + CITY_GRID_CELL - 1) / CITY_GRID_CELL)
+
+// The preview area is 2 * CITY_PREVIEW_OFFSET_X by 2 * CITY_PREVIEW_OFFSET_Y tiles
+#define MAX_HOVERED_LABELS (4 * CITY_PREVIEW_OFFSET_X * CITY_PREVIEW_OFFSET_Y)
 
 static SDL_Color highlight_color = {255, 255, 255, 80};
 static SDL_Color panel_color = {30, 30, 30, 255};
+static SDL_Color splash_color = {120, 180, 255, 255};
 
 #define CITY_NAME_LEN 30
 
@@ -59,6 +116,8 @@ static char city_names[][CITY_NAME_LEN] = {
     "Liverpool", "Dublin", "Warsaw", "Manchester", "Essen", "Los Angeles", "Cairo",
 };
 
+#define TOTAL_CITY_NAMES (int) (sizeof(city_names) / CITY_NAME_LEN)
+
 static SDL_Color player_colors[TOTAL_PLAYERS] = {
     {0, 0, 255, 70},
     {0, 255, 0, 70},
@@ -85,8 +144,22 @@ static int capital_positions[TOTAL_PLAYERS][2] = {
 };
 
 // Using the formula of hex_utils.c, these are in pixels
-#define TOTAL_TILEMAP_HEIGHT TILEMAP_HEIGHT * 16 + 16
-#define TOTAL_TILEMAP_WIDTH TILEMAP_WIDTH * (TILE_WIDTH + 16) + TILE_WIDTH
+#define TOTAL_TILEMAP_HEIGHT (TILEMAP_HEIGHT * 16 + 16)
+#define TOTAL_TILEMAP_WIDTH (TILEMAP_WIDTH * HEX_COLUMN_SPACING + TILE_WIDTH)
+
+// The window shows the whole map when it fits, bigger maps are scrolled with the camera
+// The height can't be less than what the side panel needs
+#define MAX_VIEWPORT_WIDTH 1280
+#define MAX_VIEWPORT_HEIGHT 720
+#define MIN_VIEWPORT_HEIGHT 640
+
+#define VIEWPORT_WIDTH (TOTAL_TILEMAP_WIDTH < MAX_VIEWPORT_WIDTH ? TOTAL_TILEMAP_WIDTH : MAX_VIEWPORT_WIDTH)
+#define VIEWPORT_HEIGHT (TOTAL_TILEMAP_HEIGHT < MIN_VIEWPORT_HEIGHT ? MIN_VIEWPORT_HEIGHT \
+    : TOTAL_TILEMAP_HEIGHT < MAX_VIEWPORT_HEIGHT ? TOTAL_TILEMAP_HEIGHT : MAX_VIEWPORT_HEIGHT)
+
+// Pixels per key press, and how much a notch of the mouse wheel zooms
+#define CAMERA_PAN_STEP 48
+#define CAMERA_ZOOM_STEP 1.25f
 
 typedef struct
 {
@@ -100,6 +173,16 @@ typedef struct
     int income;
 } player_t;
 
+// Indices of the kinds of ctx.effects
+typedef enum
+{
+    EFFECT_EXPLOSION,
+    EFFECT_CAPTURE_FLASH,
+    EFFECT_SPLASH,
+
+    NUM_EFFECTS,
+} effect_kind_e;
+
 // This is all the game state, accumulated in one big struct
 typedef struct
 {
@@ -111,38 +194,75 @@ typedef struct
     audio_t cannon_sfx;
     audio_t dirt_sfx;
     audio_t military_sfx;
-    animated_sprite_t explosion;
+
+    // Explosions and the rest are started by the events, see effect_kind_e
+    effect_pool_t effects;
 
     // Dropdown's with a single option are still a nice fit because they provide info and double-checking
     dropdown_t build_dropdown;
     dropdown_t train_dropdown;
     dropdown_t fix_farm_dropdown;
 
-    SDL_Texture* tilemap_texture;
-    SDL_Texture* border_texture;
-    SDL_Texture* soldiers_texture;
+    // Every image of the game is packed in here, the regions are in atlas coordinates
+    SDL_Texture* atlas_texture;
+    SDL_Rect tilemap_region;
+    SDL_Rect border_region;
+    SDL_Rect soldiers_region;
+    SDL_Rect profiles_region;
     tile_t tilemap[TILEMAP_HEIGHT][TILEMAP_WIDTH];
+    map_chunk_t chunks[TOTAL_CHUNKS_Y][TOTAL_CHUNKS_X];
+    minimap_t minimap;
+    fog_t fog;
 
     soldiers_t* selected_soldiers;
+    int selected_x, selected_y;
     audio_t soldiers_sfx;
     tile_t* highlighted_tiles[TOTAL_HIGHLIGHTED];
 
-    // player capitals + cities
-    label_t city_labels[TOTAL_LABELS];
-    bool is_label_active[TOTAL_LABELS];
-
+    // Player capitals + cities, see city_t
+    city_t cities[MAX_CITIES];
     unsigned int total_cities;
 
+    // City id + 1 of the first city of every player (so a zeroed context has no cities), the rest are chained with next_owned
+    // The neutral cities come first, see OWNED_CITIES_FOREACH
+    int first_owned_city[TOTAL_PLAYERS + 1];
+
+    // How many cities got each name
+    uint8_t name_uses[TOTAL_CITY_NAMES];
+
+    // City id + 1 of the first city of every cell, the rest are chained with next_city
+    int city_grid[CITY_GRID_HEIGHT][CITY_GRID_WIDTH];
+    int next_city[MAX_CITIES];
+
+    // The cities near the cursor, only their labels are rendered
+    int active_cities[MAX_HOVERED_LABELS];
+    int total_active_cities;
+
     // properties needed for turn-based gameplay
     player_t players[TOTAL_PLAYERS];
     int current_player_id;
     int remaining_moves;
+    unsigned int turn;
+
+    // All game randomness comes from here so that the same seed always plays out the same way
+    uint32_t random_state;
     
     // The amount of players the game starts with
     int starting_players;
 
+    // Only used by network games
+    lockstep_t lockstep;
+    spectator_t spectator;
+    int map_seed;
+
     sprite_t turn_arrow;
 
+    // Changes of the rules waiting for the frame, see events.h
+    event_bus_t events;
+
+    // Only the map is drawn through the camera, the panel is always at the right of the view
+    camera_t camera;
+
     // user interface
     label_t player_name;
     label_t player_description;
@@ -153,12 +273,26 @@ typedef struct
 
     sprite_t player_profile;
     SDL_Rect panel_rect;
+
+    // Set by the events, the panel is updated once per frame
+    bool is_panel_outdated;
+    bool are_stats_outdated;
 } context_t;
 
 // This is its globally accessible instance
+// Tools that play many games at once give every thread its own copy instead
+#ifdef THREAD_LOCAL_CONTEXT
+extern _Thread_local context_t ctx;
+#else
 extern context_t ctx;
+#endif
 
 // Some utility functions
-SDL_Texture* load_texture(const char* file);
+// Seeds both the terrain noise and the game randomness
+void set_map_seed(int seed);
+
+// Returns a number in [0, max)
+int random_range(int max);
+bool random_chance(int max);
 
 #endif
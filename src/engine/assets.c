@@ -0,0 +1,118 @@
+#include <stdatomic.h>
+#include <SDL2/SDL_image.h>
+
+#include "assets.h"
+#include "atlas.h"
+#include "thread_pool.h"
+#include "utils.h"
+
+void add_texture_asset(asset_loader_t* loader, const char* path, SDL_Texture** texture)
+{
+    assert_panic(loader->total_textures == MAX_TEXTURE_ASSETS, "Too many textures, increase MAX_TEXTURE_ASSETS");
+
+    loader->textures[loader->total_textures++] = (texture_asset_t) {path, texture, NULL};
+}
+
+void add_atlas_asset(asset_loader_t* loader, const char* path, SDL_Rect* region)
+{
+    assert_panic(loader->total_textures == MAX_TEXTURE_ASSETS, "Too many textures, increase MAX_TEXTURE_ASSETS");
+
+    loader->textures[loader->total_textures++] = (texture_asset_t) {path, NULL, region};
+}
+
+void add_audio_asset(asset_loader_t* loader, const char* path, audio_t* audio)
+{
+    assert_panic(loader->total_sounds == MAX_AUDIO_ASSETS, "Too many sounds, increase MAX_AUDIO_ASSETS");
+
+    loader->sounds[loader->total_sounds++] = (audio_asset_t) {path, audio};
+}
+
+// Task 0 opens the audio device and decodes every sound, because sounds are converted to the format of the device
+// The rest of the tasks decode a single image each
+static void decode_asset(int task_index, int thread_index, void* data)
+{
+    asset_loader_t* loader = data;
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    if (task_index == 0)
+    {
+        open_audio_device();
+
+        for (int i = 0; i < loader->total_sounds; i++)
+            *loader->sounds[i].audio = load_audio(loader->sounds[i].path);
+    }
+    else
+    {
+        texture_asset_t* asset = &loader->textures[task_index - 1];
+
+        asset->surface = IMG_Load(asset->path);
+        assert_panic(!asset->surface, "Something went wrong, couldn't load an image!");
+    }
+
+    atomic_fetch_add(&loader->decoding_ticks, SDL_GetPerformanceCounter() - start);
+}
+
+static int run_loader(void* data)
+{
+    asset_loader_t* loader = data;
+
+    int total_tasks = loader->total_textures + 1;
+    int total_threads = get_default_thread_count();
+
+    run_tasks_in_parallel(total_tasks, total_threads < total_tasks ? total_threads : total_tasks, decode_asset, loader);
+
+    // Packing here as well, so the main thread only has to upload a single texture
+    SDL_Surface* surfaces[MAX_TEXTURE_ASSETS];
+    SDL_Rect regions[MAX_TEXTURE_ASSETS];
+    int total_surfaces = 0;
+
+    for (int i = 0; i < loader->total_textures; i++)
+    {
+        if (loader->textures[i].region)
+            surfaces[total_surfaces++] = loader->textures[i].surface;
+    }
+
+    if (total_surfaces == 0)
+        return 0;
+
+    loader->atlas_surface = pack_atlas_surface(surfaces, total_surfaces, regions);
+
+    for (int i = 0, j = 0; i < loader->total_textures; i++)
+    {
+        if (loader->textures[i].region)
+            *loader->textures[i].region = regions[j++];
+    }
+
+    return 0;
+}
+
+void start_loading_assets(asset_loader_t* loader)
+{
+    // Initializing these here so that the workers don't race with each other or with the window creation
+    assert_panic(SDL_InitSubSystem(SDL_INIT_AUDIO) < 0, "Something went wrong, couldn't initialize the audio");
+    assert_panic((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0, "Failed to initialize SDL_image for whatever reason");
+
+    atomic_init(&loader->decoding_ticks, 0);
+    loader->thread = SDL_CreateThread(run_loader, "asset loader", loader);
+}
+
+void finish_loading_assets(asset_loader_t* loader, SDL_Renderer* renderer)
+{
+    SDL_WaitThread(loader->thread, NULL);
+
+    for (int i = 0; i < loader->total_textures; i++)
+    {
+        texture_asset_t* asset = &loader->textures[i];
+
+        if (asset->texture)
+            *asset->texture = SDL_CreateTextureFromSurface(renderer, asset->surface);
+
+        SDL_FreeSurface(asset->surface);
+    }
+
+    if (loader->atlas_surface)
+    {
+        loader->atlas = SDL_CreateTextureFromSurface(renderer, loader->atlas_surface);
+        SDL_FreeSurface(loader->atlas_surface);
+    }
+}
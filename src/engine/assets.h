@@ -0,0 +1,63 @@
+#ifndef _ASSETS_H
+#define _ASSETS_H
+
+#include <stdint.h>
+#include <SDL2/SDL.h>
+#include "audio.h"
+
+/*
+ * Loads the images and the sounds in the background while the window is being created
+ * Files are decoded on worker threads, only the textures are created on the main thread because they need the renderer
+ * Atlas assets are packed together into a single texture (see atlas.h), only their region inside of it is returned
+ */
+
+#define MAX_TEXTURE_ASSETS 16
+#define MAX_AUDIO_ASSETS 16
+
+typedef struct
+{
+    const char* path;
+    SDL_Texture** texture;
+
+    // Only set for atlas assets, texture is NULL then
+    SDL_Rect* region;
+
+    SDL_Surface* surface;
+} texture_asset_t;
+
+typedef struct
+{
+    const char* path;
+    audio_t* audio;
+} audio_asset_t;
+
+typedef struct
+{
+    texture_asset_t textures[MAX_TEXTURE_ASSETS];
+    int total_textures;
+
+    audio_asset_t sounds[MAX_AUDIO_ASSETS];
+    int total_sounds;
+
+    SDL_Thread* thread;
+
+    // Packed by the loader thread once every image is decoded, the texture exists after finish_loading_assets
+    SDL_Surface* atlas_surface;
+    SDL_Texture* atlas;
+
+    // Performance counter ticks summed over every worker, so it can be more than the time it actually took
+    _Atomic uint64_t decoding_ticks;
+} asset_loader_t;
+
+// The results are written to the pointers once finish_loading_assets returns
+void add_texture_asset(asset_loader_t* loader, const char* path, SDL_Texture** texture);
+void add_atlas_asset(asset_loader_t* loader, const char* path, SDL_Rect* region);
+void add_audio_asset(asset_loader_t* loader, const char* path, audio_t* audio);
+
+// Returns right away, the audio device is opened by one of the workers too
+void start_loading_assets(asset_loader_t* loader);
+
+// Waits for the workers and creates the textures, must be called from the thread of the renderer
+void finish_loading_assets(asset_loader_t* loader, SDL_Renderer* renderer);
+
+#endif
@@ -0,0 +1,86 @@
+#include "atlas.h"
+#include "utils.h"
+
+#define MAX_ATLAS_SURFACES 32
+
+// Tallest first, the original order is kept for ties so that the layout never changes between runs
+// Insertion sort because an atlas only has a handful of images
+static void sort_by_height(SDL_Surface** surfaces, int* order, int total_surfaces)
+{
+    for (int i = 1; i < total_surfaces; i++)
+    {
+        int current = order[i], j = i;
+
+        for (; j > 0 && surfaces[order[j - 1]]->h < surfaces[current]->h; j--)
+            order[j] = order[j - 1];
+
+        order[j] = current;
+    }
+}
+
+// Places the images in rows of the given width and returns the total height
+static int place_on_shelves(SDL_Surface** surfaces, const int* order, int total_surfaces, int atlas_width, SDL_Rect* regions)
+{
+    int shelf_x = 0, shelf_y = 0, shelf_height = 0;
+
+    for (int i = 0; i < total_surfaces; i++)
+    {
+        SDL_Surface* surface = surfaces[order[i]];
+
+        if (shelf_x + surface->w > atlas_width)
+        {
+            shelf_y += shelf_height + ATLAS_PADDING;
+            shelf_x = shelf_height = 0;
+        }
+
+        // The first image of a shelf is the tallest because of the sorting
+        if (shelf_x == 0)
+            shelf_height = surface->h;
+
+        regions[order[i]] = (SDL_Rect) {shelf_x, shelf_y, surface->w, surface->h};
+        shelf_x += surface->w + ATLAS_PADDING;
+    }
+
+    return shelf_y + shelf_height;
+}
+
+SDL_Surface* pack_atlas_surface(SDL_Surface** surfaces, int total_surfaces, SDL_Rect* regions)
+{
+    assert_panic(total_surfaces > MAX_ATLAS_SURFACES, "Too many images for a single atlas");
+
+    int order[MAX_ATLAS_SURFACES];
+    int total_area = 0, widest = 0;
+
+    for (int i = 0; i < total_surfaces; i++)
+    {
+        order[i] = i;
+        total_area += (surfaces[i]->w + ATLAS_PADDING) * (surfaces[i]->h + ATLAS_PADDING);
+        widest = MAX(widest, surfaces[i]->w);
+    }
+
+    sort_by_height(surfaces, order, total_surfaces);
+
+    // Smallest power of two that could fit everything in a square, GPUs still like those
+    int atlas_width = 64;
+    while (atlas_width < widest || atlas_width * atlas_width < total_area)
+        atlas_width *= 2;
+
+    int atlas_height = place_on_shelves(surfaces, order, total_surfaces, atlas_width, regions);
+
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, atlas_width, atlas_height, 32, SDL_PIXELFORMAT_RGBA32);
+    assert_panic(!atlas, "Couldn't create the surface of the atlas");
+
+    for (int i = 0; i < total_surfaces; i++)
+    {
+        // Copying the pixels as they are instead of blending them with the empty atlas
+        SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(surfaces[i], NULL, atlas, &regions[i]);
+    }
+
+    return atlas;
+}
+
+SDL_Rect get_atlas_rect(const SDL_Rect* region, int x, int y, int w, int h)
+{
+    return (SDL_Rect) {region->x + x, region->y + y, w, h};
+}
@@ -0,0 +1,21 @@
+#ifndef _ATLAS_H
+#define _ATLAS_H
+
+#include <SDL2/SDL.h>
+
+/*
+ * Packs many images into a single one so that everything can be drawn from the same texture
+ * Consecutive draws of the same texture can be batched by the renderer, switching textures can't
+ */
+
+// 1 pixel between the images so that scaled draws never sample a neighbouring image
+#define ATLAS_PADDING 1
+
+// Shelf packing, tallest images first. regions[i] is where surfaces[i] was copied to
+// The surfaces aren't freed, the caller owns the returned surface too
+SDL_Surface* pack_atlas_surface(SDL_Surface** surfaces, int total_surfaces, SDL_Rect* regions);
+
+// A rectangle of a packed image, (x, y) are relative to the image
+SDL_Rect get_atlas_rect(const SDL_Rect* region, int x, int y, int w, int h);
+
+#endif
@@ -1,6 +1,12 @@
 #include "audio.h"
 #include "utils.h"
 
+void open_audio_device()
+{
+    // Opening the default audio device with standard configuration
+    assert_panic(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0, "Failed to open audio device!");
+}
+
 audio_t load_audio(const char* file)
 {
     audio_t audio = Mix_LoadWAV(file);
@@ -13,6 +19,9 @@ audio_t load_audio(const char* file)
 
 void play_audio(audio_t audio)
 {
+    // Nothing has been loaded when there is no window
+    if (!audio) return;
+
     Mix_PlayChannel(-1, audio, 0);
 }
 
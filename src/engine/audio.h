@@ -6,6 +6,9 @@
 // This is just for consistency, although really pointless and confusing
 typedef Mix_Chunk* audio_t;
 
+// Sounds can only be loaded after this, SDL_INIT_AUDIO must have been initialized before
+void open_audio_device();
+
 audio_t load_audio(const char* file);
 
 void play_audio(audio_t audio);
@@ -0,0 +1,103 @@
+#include <math.h>
+
+#include "camera.h"
+#include "utils.h"
+
+void create_camera(camera_t* camera, int view_width, int view_height, int world_width, int world_height)
+{
+    camera->view_width = view_width;
+    camera->view_height = view_height;
+    camera->world_width = world_width;
+    camera->world_height = world_height;
+
+    camera->zoom = 1;
+    camera->max_zoom = 4;
+
+    // Zooming out until the whole world fits, but not so far that nothing can be seen
+    camera->min_zoom = 1;
+
+    while (camera->min_zoom > 1 / 64.0 && (world_width * camera->min_zoom > view_width || world_height * camera->min_zoom > view_height))
+        camera->min_zoom /= 2;
+
+    camera->position = (vec2) {0, 0};
+
+    move_camera(camera, 0, 0);
+}
+
+static float clamp_axis(float position, int view_size, int world_size, float zoom)
+{
+    float visible_size = view_size / zoom;
+
+    if (visible_size >= world_size)
+        return (world_size - visible_size) / 2;
+
+    if (position < 0)
+        return 0;
+
+    if (position > world_size - visible_size)
+        return world_size - visible_size;
+
+    return position;
+}
+
+void move_camera(camera_t* camera, float screen_x, float screen_y)
+{
+    camera->position.x = clamp_axis(camera->position.x + screen_x / camera->zoom, camera->view_width, camera->world_width, camera->zoom);
+    camera->position.y = clamp_axis(camera->position.y + screen_y / camera->zoom, camera->view_height, camera->world_height, camera->zoom);
+}
+
+void zoom_camera_at(camera_t* camera, float factor, int screen_x, int screen_y)
+{
+    float zoom = camera->zoom * factor;
+
+    if (zoom < camera->min_zoom)
+        zoom = camera->min_zoom;
+    else if (zoom > camera->max_zoom)
+        zoom = camera->max_zoom;
+
+    // The world point under the cursor stays under the cursor
+    float world_x = camera->position.x + screen_x / camera->zoom;
+    float world_y = camera->position.y + screen_y / camera->zoom;
+
+    camera->zoom = zoom;
+    camera->position.x = world_x - screen_x / zoom;
+    camera->position.y = world_y - screen_y / zoom;
+
+    move_camera(camera, 0, 0);
+}
+
+bool is_inside_view(const camera_t* camera, int screen_x, int screen_y)
+{
+    return screen_x >= 0 && screen_x < camera->view_width && screen_y >= 0 && screen_y < camera->view_height;
+}
+
+void screen_to_world(const camera_t* camera, int screen_x, int screen_y, int* world_x, int* world_y)
+{
+    *world_x = (int) floorf(camera->position.x + screen_x / camera->zoom);
+    *world_y = (int) floorf(camera->position.y + screen_y / camera->zoom);
+}
+
+SDL_Rect world_to_screen_rect(const camera_t* camera, const SDL_Rect* rect)
+{
+    // Rounding the edges instead of the size
+    int left = (int) floorf((rect->x - camera->position.x) * camera->zoom);
+    int top = (int) floorf((rect->y - camera->position.y) * camera->zoom);
+    int right = (int) floorf((rect->x + rect->w - camera->position.x) * camera->zoom);
+    int bottom = (int) floorf((rect->y + rect->h - camera->position.y) * camera->zoom);
+
+    return (SDL_Rect) {left, top, right - left, bottom - top};
+}
+
+SDL_Rect get_camera_view(const camera_t* camera)
+{
+    int left = (int) floorf(camera->position.x);
+    int top = (int) floorf(camera->position.y);
+
+    return (SDL_Rect) {left, top, (int) ceilf(camera->view_width / camera->zoom) + 1, (int) ceilf(camera->view_height / camera->zoom) + 1};
+}
+
+void render_sprite_in_camera(const camera_t* camera, sprite_t* sprite, SDL_Renderer* renderer)
+{
+    SDL_Rect rect = world_to_screen_rect(camera, &sprite->transform.rect);
+    SDL_RenderCopy(renderer, sprite->texture, &sprite->source_rect, &rect);
+}
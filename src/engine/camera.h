@@ -0,0 +1,42 @@
+#ifndef _CAMERA_H
+#define _CAMERA_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "custom_math.h"
+#include "sprite.h"
+
+/*
+ * A 2D camera over a world that is bigger than the part of the window it's drawn in
+ * Everything in the world keeps its world coordinates, only the rendering goes through the camera
+ */
+
+typedef struct
+{
+    // World position of the top left corner of the view
+    vec2 position;
+    float zoom, min_zoom, max_zoom;
+
+    // Size of the view in window pixels, the view always starts at the top left of the window
+    int view_width, view_height;
+    int world_width, world_height;
+} camera_t;
+
+void create_camera(camera_t* camera, int view_width, int view_height, int world_width, int world_height);
+
+// Both keep the view inside the world, if the world is smaller than the view it's centered instead
+void move_camera(camera_t* camera, float screen_x, float screen_y);
+void zoom_camera_at(camera_t* camera, float factor, int screen_x, int screen_y);
+
+bool is_inside_view(const camera_t* camera, int screen_x, int screen_y);
+void screen_to_world(const camera_t* camera, int screen_x, int screen_y, int* world_x, int* world_y);
+
+// Neighbouring rects stay neighbours after the transform, so tiles never have gaps between them
+SDL_Rect world_to_screen_rect(const camera_t* camera, const SDL_Rect* rect);
+
+// The part of the world that is visible
+SDL_Rect get_camera_view(const camera_t* camera);
+
+void render_sprite_in_camera(const camera_t* camera, sprite_t* sprite, SDL_Renderer* renderer);
+
+#endif
@@ -0,0 +1,85 @@
+#include "effects.h"
+#include "utils.h"
+
+static unsigned int get_effect_duration(const effect_kind_t* kind)
+{
+    return kind->total_frames * kind->frame_duration_ms;
+}
+
+void set_effect_kind(effect_pool_t* pool, int kind, const effect_kind_t* definition)
+{
+    assert_panic(kind < 0 || kind >= MAX_EFFECT_KINDS, "Too many effect kinds, increase MAX_EFFECT_KINDS");
+    pool->kinds[kind] = *definition;
+}
+
+void play_effect(effect_pool_t* pool, int kind, int x, int y, SDL_Color color)
+{
+    effect_t* effect;
+
+    if (pool->total_effects < MAX_EFFECTS)
+    {
+        effect = &pool->effects[pool->total_effects++];
+    }
+    else
+    {
+        // A full pool only happens with lots of effects at once, so looking for the oldest is cheap enough
+        effect = &pool->effects[0];
+
+        for (int i = 1; i < MAX_EFFECTS; i++)
+        {
+            if (pool->effects[i].starting_time < effect->starting_time)
+                effect = &pool->effects[i];
+        }
+    }
+
+    *effect = (effect_t) {kind, pool->time, x, y, color};
+}
+
+void update_effects(effect_pool_t* pool, uint32_t time)
+{
+    pool->time = time;
+
+    for (int i = 0; i < pool->total_effects; )
+    {
+        const effect_t* effect = &pool->effects[i];
+
+        if (time - effect->starting_time >= get_effect_duration(&pool->kinds[effect->kind]))
+            pool->effects[i] = pool->effects[--pool->total_effects];
+        else
+            i++;
+    }
+}
+
+void render_effects(const effect_pool_t* pool, SDL_Texture* texture, const camera_t* camera, SDL_Renderer* renderer)
+{
+    if (pool->total_effects == 0) return;
+
+    for (int i = 0; i < pool->total_effects; i++)
+    {
+        const effect_t* effect = &pool->effects[i];
+        const effect_kind_t* kind = &pool->kinds[effect->kind];
+
+        unsigned int elapsed_time = pool->time - effect->starting_time;
+        unsigned int frame_width = kind->region.w / kind->total_frames;
+
+        SDL_Rect source_rect = {kind->region.x + frame_width * (elapsed_time / kind->frame_duration_ms), kind->region.y, frame_width, kind->region.h};
+
+        int width = frame_width * kind->scale;
+        int height = kind->region.h * kind->scale;
+        SDL_Rect world_rect = {effect->x - width / 2, effect->y - height / 2, width, height};
+        SDL_Rect dest_rect = world_to_screen_rect(camera, &world_rect);
+
+        int alpha = effect->color.a;
+
+        if (kind->fades_out)
+            alpha -= alpha * elapsed_time / get_effect_duration(kind);
+
+        // The renderer batches copies of the same texture, the tint is just part of every copy
+        SDL_SetTextureColorMod(texture, effect->color.r, effect->color.g, effect->color.b);
+        SDL_SetTextureAlphaMod(texture, alpha);
+        SDL_RenderCopy(renderer, texture, &source_rect, &dest_rect);
+    }
+
+    SDL_SetTextureColorMod(texture, 255, 255, 255);
+    SDL_SetTextureAlphaMod(texture, 255);
+}
@@ -0,0 +1,64 @@
+#ifndef _EFFECTS_H
+#define _EFFECTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "camera.h"
+
+/*
+ * Short animations that are played somewhere in the world and forgotten, like explosions
+ * Every effect lives in a fixed pool and is animated by the clock of the frame, so starting one never allocates
+ * Up to MAX_EFFECTS play at once, after that starting one evicts the oldest
+ * They are all drawn from the same texture in a single pass
+ */
+
+// Bots can fight a lot of battles in a single frame and conquering a player flashes every one of its tiles,
+// when the pool is full the oldest effect makes room (a big conquest only shows its last flashes)
+#define MAX_EFFECTS 512
+#define MAX_EFFECT_KINDS 8
+
+typedef struct
+{
+    // The frames are laid out horizontally inside of the region
+    SDL_Rect region;
+    unsigned int total_frames, frame_duration_ms;
+    float scale;
+
+    // The alpha goes from the one of the color down to zero over the whole animation
+    bool fades_out;
+} effect_kind_t;
+
+typedef struct
+{
+    int kind;
+    uint32_t starting_time;
+
+    // Centered in world coordinates
+    int x, y;
+    SDL_Color color;
+} effect_t;
+
+typedef struct
+{
+    effect_kind_t kinds[MAX_EFFECT_KINDS];
+
+    // Only the playing ones, finished effects are replaced by the last one
+    effect_t effects[MAX_EFFECTS];
+    int total_effects;
+
+    // The frame clock, every effect is animated from it
+    uint32_t time;
+} effect_pool_t;
+
+void set_effect_kind(effect_pool_t* pool, int kind, const effect_kind_t* definition);
+
+// Starts at the current time of the pool, the color tints the frames (white leaves them as they are)
+void play_effect(effect_pool_t* pool, int kind, int x, int y, SDL_Color color);
+
+// Called once per frame before any effect is played, removes the ones that have finished
+void update_effects(effect_pool_t* pool, uint32_t time);
+
+void render_effects(const effect_pool_t* pool, SDL_Texture* texture, const camera_t* camera, SDL_Renderer* renderer);
+
+#endif
@@ -8,14 +8,11 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 
+// Only what the window needs, the rest (like the audio, haptics or game controllers) is initialized by whoever uses it
 void initialize_sdl_components()
 {
-    assert_panic(SDL_Init(SDL_INIT_EVERYTHING) < 0, "Something went wrong, couldn't initialize SDL2");
-    assert_panic(IMG_Init(IMG_INIT_PNG) < 0, "Failed to initialize SDL_image for whatever reason");
+    assert_panic(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) < 0, "Something went wrong, couldn't initialize SDL2");
     assert_panic(TTF_Init() < 0, "Failed to initialize TTF_font");
-
-    // Opening the default audio device with standard configuration
-    assert_panic(Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0, "Failed to open audio device!");
 }
 
 void create_game(game_t* game, const char* title, unsigned int width, unsigned int height, unsigned int frames_per_second)
@@ -25,27 +22,70 @@ void create_game(game_t* game, const char* title, unsigned int width, unsigned i
 
     // Creating the window at the center of the screen by default
     game->window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_SHOWN);
-    game->renderer = SDL_CreateRenderer(game->window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
+    uint32_t flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
+
+    if (frames_per_second == 0)
+        flags |= SDL_RENDERER_PRESENTVSYNC;
+
+    game->renderer = SDL_CreateRenderer(game->window, -1, flags);
 
     game->width = width;
     game->height = height;
-    game->frame_delay = 1000 / frames_per_second;
+    game->frame_delay = frames_per_second == 0 ? 0 : 1000 / frames_per_second;
+
+    // Some drivers can't wait for the vsync, the frames would be drawn as fast as possible then
+    SDL_RendererInfo info;
+
+    if (frames_per_second == 0 && SDL_GetRendererInfo(game->renderer, &info) == 0 && !(info.flags & SDL_RENDERER_PRESENTVSYNC))
+        game->frame_delay = 1000 / FALLBACK_FRAMES_PER_SECOND;
+}
+
+static void update_dropdown_hover(game_t* game)
+{
+    if (game->is_dropdown_hover_stale && game->active_dropdown)
+        on_dropdown_mouse_move(game->active_dropdown, game->mouse_x, game->mouse_y);
+
+    game->is_dropdown_hover_stale = false;
 }
 
 void handle_event(game_t* game, SDL_Event* event)
 {
-    if (event->type == SDL_MOUSEMOTION && game->active_dropdown)
+    // High polling rate mice send hundreds of these per frame, so only the latest position is kept
+    if (event->type == SDL_MOUSEMOTION)
+    {
+        game->mouse_x = event->motion.x;
+        game->mouse_y = event->motion.y;
+        game->has_mouse_moved = game->is_dropdown_hover_stale = true;
+    }
+    // A click has to choose the item that was under the cursor right before it
+    else if (event->type == SDL_MOUSEBUTTONDOWN)
     {
-        on_dropdown_mouse_move(game->active_dropdown, event->motion.x, event->motion.y);
+        update_dropdown_hover(game);
     }
 }
 
+bool collect_mouse_motion(game_t* game)
+{
+    update_dropdown_hover(game);
+
+    bool has_mouse_moved = game->has_mouse_moved;
+    game->has_mouse_moved = false;
+
+    return has_mouse_moved;
+}
+
 void activate_dropdown_at(game_t* game, dropdown_t* dropdown, int x, int y)
 {
     game->active_dropdown = dropdown;
     set_dropdown_position(game->active_dropdown, x, y);
 }
 
+void track_input_latency(game_t* game, uint32_t input_time)
+{
+    if (game->total_pending_inputs < MAX_PENDING_INPUTS)
+        game->pending_inputs[game->total_pending_inputs++] = input_time;
+}
+
 // Finishes off the SDL rendering process and draws the active dropdown as well
 void finish_game_rendering(game_t* game)
 {
@@ -53,7 +93,23 @@ void finish_game_rendering(game_t* game)
         render_dropdown(game->active_dropdown, game->renderer);
 
     SDL_RenderPresent(game->renderer);
-    SDL_Delay(game->frame_delay);
+
+    // With the vsync the present only returns once the frame is about to be on screen
+    if (game->total_pending_inputs > 0)
+    {
+        uint32_t now = SDL_GetTicks();
+
+        for (int i = 0; i < game->total_pending_inputs; i++)
+            record_latency(&game->input_latency, now - game->pending_inputs[i]);
+
+        game->total_pending_inputs = 0;
+    }
+
+    if (!game->first_present_time)
+        game->first_present_time = SDL_GetPerformanceCounter();
+
+    if (game->frame_delay > 0)
+        SDL_Delay(game->frame_delay);
 }
 
 int get_dropdown_choice(game_t* game, dropdown_t* dropdown)
@@ -73,6 +129,7 @@ void free_game(game_t* game)
     SDL_DestroyRenderer(game->renderer);
 
     IMG_Quit();
+    Mix_CloseAudio();
     Mix_Quit();
     SDL_Quit();
 }
@@ -3,6 +3,13 @@
 
 #include <SDL2/SDL.h>
 #include "interface.h"
+#include "timers.h"
+
+// Used instead of the vsync when the renderer doesn't support it
+#define FALLBACK_FRAMES_PER_SECOND 60
+
+// Inputs that wait for a frame to show them, more than that in a single frame are not measured
+#define MAX_PENDING_INPUTS 16
 
 /*
  * A struct containing generic properties for any kind of game
@@ -16,21 +23,46 @@ typedef struct
 
     unsigned int width, height;
 
-    // How much the game should wait between each frame
+    // How much the game should wait between each frame, zero when the presents wait for the vsync instead
     unsigned int frame_delay;
 
+    // SDL_GetTicks at the start of the frame, everything that animates uses it so that a frame is drawn at a single time
+    uint32_t frame_time;
+
     dropdown_t* active_dropdown;
+
+    // Latest cursor position, motion events only update these and the work is done once per frame
+    int mouse_x, mouse_y;
+    bool has_mouse_moved;
+    bool is_dropdown_hover_stale;
+
+    // Performance counter value when the first frame was on screen, for measuring the startup
+    uint64_t first_present_time;
+
+    // Timestamps (of the SDL events) of the inputs that changed something which isn't on screen yet
+    // Once a frame is presented, the time since each of them is recorded in input_latency
+    uint32_t pending_inputs[MAX_PENDING_INPUTS];
+    int total_pending_inputs;
+    latency_histogram_t input_latency;
 } game_t;
 
 // Creates the window and initializes the SDL components
+// With zero frames_per_second the frames follow the refresh rate of the display
 void create_game(game_t* game, const char* title, unsigned int width, unsigned int height, unsigned int frames_per_second);
 
 // Helper methods for making dropdown menu handling easier, but of course not limited to that
 // This behaviour is generic and will be used throughout all future games too, it's a bit faster performance wise and typing wise
 void handle_event(game_t* game, SDL_Event* event);
+
+// Call once per frame after polling the events, returns true if the mouse moved since the last frame
+bool collect_mouse_motion(game_t* game);
+
 void activate_dropdown_at(game_t* game, dropdown_t* dropdown, int x, int y);
 int get_dropdown_choice(game_t* game, dropdown_t* dropdown);
 
+// The input_time is the timestamp of the SDL event, its latency is recorded when the next frame is presented
+void track_input_latency(game_t* game, uint32_t input_time);
+
 void finish_game_rendering(game_t* game);
 void free_game(game_t* game);
 
@@ -7,7 +7,10 @@
 void create_label(label_t* label, TTF_Font* font, unsigned int wrap_length)
 {
     label->font = font;
-    label->content = NULL;
+    label->content[0] = '\0';
+
+    label->sprite.texture = NULL;
+    label->texture_width = label->texture_height = 0;
 
     label->color = (SDL_Color) {255, 255, 255, 255};
     label->wrap_length = wrap_length;
@@ -16,30 +19,85 @@ void create_label(label_t* label, TTF_Font* font, unsigned int wrap_length)
 void destroy_label(label_t* label)
 {
     SDL_DestroyTexture(label->sprite.texture);
+
+    label->sprite.texture = NULL;
+    label->texture_width = label->texture_height = 0;
+    label->content[0] = '\0';
 }
 
-void update_label_texture(label_t* label, SDL_Renderer* renderer)
+// Solid text is rendered with a palette, the colorkey is the transparent background
+static void copy_text_pixels(SDL_Surface* surface, uint32_t* pixels, int pitch)
 {
-    SDL_DestroyTexture(label->sprite.texture);
+    assert_panic(surface->format->BytesPerPixel != 1, "Labels expect text surfaces with a palette");
+
+    SDL_Color* colors = surface->format->palette->colors;
+    Uint32 colorkey;
+    bool has_colorkey = SDL_GetColorKey(surface, &colorkey) == 0;
+
+    for (int y = 0; y < surface->h; y++)
+    {
+        uint8_t* source = (uint8_t*) surface->pixels + y * surface->pitch;
+        uint32_t* dest = (uint32_t*) ((uint8_t*) pixels + y * pitch);
 
+        for (int x = 0; x < surface->w; x++)
+        {
+            SDL_Color color = colors[source[x]];
+            dest[x] = has_colorkey && source[x] == colorkey ? 0 : (uint32_t) color.a << 24 | color.r << 16 | color.g << 8 | color.b;
+        }
+    }
+}
+
+static void update_label_texture(label_t* label, SDL_Renderer* renderer)
+{
     SDL_Surface* label_surface = label->wrap_length > 0
         ? TTF_RenderText_Solid_Wrapped(label->font, label->content, label->color, label->wrap_length)
         : TTF_RenderText_Solid(label->font, label->content, label->color);
 
-    create_sprite(&label->sprite, SDL_CreateTextureFromSurface(renderer, label_surface));
+    assert_panic(!label_surface, "Couldn't render the text of a label");
+
+    // Growing the texture to fit the new text, it is never shrunk because the text usually changes back and forth
+    if (!label->sprite.texture || label_surface->w > label->texture_width || label_surface->h > label->texture_height)
+    {
+        SDL_DestroyTexture(label->sprite.texture);
+
+        label->texture_width = MAX(label->texture_width, label_surface->w);
+        label->texture_height = MAX(label->texture_height, label_surface->h);
+
+        label->sprite.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+            label->texture_width, label->texture_height);
+
+        assert_panic(!label->sprite.texture, "Couldn't create the texture of a label");
+        SDL_SetTextureBlendMode(label->sprite.texture, SDL_BLENDMODE_BLEND);
+    }
+
+    SDL_Rect area = {0, 0, label_surface->w, label_surface->h};
+    void* pixels;
+    int pitch;
+
+    if (SDL_LockTexture(label->sprite.texture, &area, &pixels, &pitch) == 0)
+    {
+        copy_text_pixels(label_surface, pixels, pitch);
+        SDL_UnlockTexture(label->sprite.texture);
+    }
+
+    // Only the part of the texture with the new text is drawn
+    create_sprite_from_region(&label->sprite, label->sprite.texture, &area);
     SDL_FreeSurface(label_surface);
 }
 
 // Warning: the user must reset the origin if they want the text to be centered again, because the dimensions will change!
 void set_label_content(label_t* label, SDL_Renderer* renderer, const char* content)
 {
-    // I'm not sure if this is the most efficient way of doing it...
-    if (label->content)
-        free(label->content);
+    // Most of the updates (like the stats after every move) write the same text again
+    if (strcmp(label->content, content) == 0 && (label->sprite.texture || !renderer))
+        return;
 
-    label->content = strdup(content);
+    assert_panic(strlen(content) >= LABEL_MAX_LENGTH, "The content of the label is too long, increase LABEL_MAX_LENGTH");
+    strcpy(label->content, content);
 
-    update_label_texture(label, renderer);
+    // Games without a window (like the tools) still keep the content but never draw it
+    if (renderer)
+        update_label_texture(label, renderer);
 }
 
 void set_label_color(label_t* label, SDL_Renderer* renderer, SDL_Color color)
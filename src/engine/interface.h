@@ -4,21 +4,28 @@
 #include <stdbool.h>
 #include "sprite.h"
 
+// The longest text a label can have, the player descriptions are the longest ones
+#define LABEL_MAX_LENGTH 256
+
 // Labels will be defined as sprites as well
+// The texture is streaming and only replaced when the new text doesn't fit in it, so changing the text doesn't allocate it again
 typedef struct
 {
     sprite_t sprite;
+    int texture_width, texture_height;
 
     TTF_Font* font;
     SDL_Color color;
 
-    char* content;
+    // Empty when the label isn't used
+    char content[LABEL_MAX_LENGTH];
     unsigned int wrap_length;
 } label_t;
 
 // Leave wrap_length to 0 for default rendering
 void create_label(label_t* label, TTF_Font* font, unsigned int wrap_length);
 
+// Does nothing if the label already shows this content
 void set_label_content(label_t* label, SDL_Renderer* renderer, const char* content);
 void set_label_color(label_t* label, SDL_Renderer* renderer, SDL_Color color);
 void destroy_label(label_t* label);
@@ -51,51 +51,18 @@ void create_sprite(sprite_t* sprite, SDL_Texture* texture)
     sprite->transform.rect.h = sprite->source_rect.h;
 }
 
-void render_sprite(sprite_t* sprite, SDL_Renderer* renderer)
-{
-    SDL_RenderCopy(renderer, sprite->texture, &sprite->source_rect, &sprite->transform.rect);
-}
-
-// (Animated sprite)-specific methods
-void create_animated_sprite(animated_sprite_t* anim_sprite, SDL_Texture* texture, unsigned int total_frames, unsigned int frame_duration_ms)
+void create_sprite_from_region(sprite_t* sprite, SDL_Texture* texture, const SDL_Rect* region)
 {
-    create_sprite(&anim_sprite->sprite, texture);
+    sprite->texture = texture;
+    memset(sprite->transform.origin, 0, 2 * sizeof(int));
 
-    anim_sprite->is_active = false;
-    anim_sprite->total_frames = total_frames;
-    anim_sprite->frame_duration_ms = frame_duration_ms;
-    anim_sprite->frame_width = anim_sprite->sprite.transform.rect.w / total_frames;
+    sprite->source_rect = *region;
 
-    // Fixing the rect's width so it doesn't count the whole texture
-    anim_sprite->sprite.source_rect.w = anim_sprite->sprite.transform.rect.w = anim_sprite->frame_width;
+    sprite->transform.rect.w = region->w;
+    sprite->transform.rect.h = region->h;
 }
 
-void play_animated_sprite(animated_sprite_t* anim_sprite)
-{
-    start_timer(&anim_sprite->anim_timer);
-    anim_sprite->is_active = true;
-}
-
-void render_animated_sprite(animated_sprite_t* anim_sprite, SDL_Renderer* renderer)
+void render_sprite(sprite_t* sprite, SDL_Renderer* renderer)
 {
-    unsigned int current_frame = 0;
-
-    if (anim_sprite->is_active)
-    {
-        unsigned int elapsed_time = SDL_GetTicks() - anim_sprite->anim_timer.starting_time;
-        current_frame = elapsed_time / anim_sprite->frame_duration_ms;
-
-        // Check if the animation has ended
-        if (current_frame == anim_sprite->total_frames - 1)
-        {
-            anim_sprite->is_active = false;
-            current_frame = 0;
-
-            return;
-        }
-    }
-
-    anim_sprite->sprite.source_rect.x = anim_sprite->frame_width * current_frame;
-    render_sprite(&anim_sprite->sprite, renderer);
+    SDL_RenderCopy(renderer, sprite->texture, &sprite->source_rect, &sprite->transform.rect);
 }
-
@@ -36,24 +36,9 @@ typedef struct
 } sprite_t;
 
 void create_sprite(sprite_t* sprite, SDL_Texture* texture);
-void render_sprite(sprite_t* sprite, SDL_Renderer* renderer);
-
-
-// Animated sprite
-typedef struct
-{
-    sprite_t sprite;
-    simple_timer_t anim_timer;
 
-    unsigned int frame_width, total_frames, frame_duration_ms;
-    bool is_active;
-} animated_sprite_t;
-
-void create_animated_sprite(animated_sprite_t* anim_sprite, SDL_Texture* texture, unsigned int total_frames, unsigned int frame_duration_ms);
-
-// Starts the animated sprite's animation and timer
-void play_animated_sprite(animated_sprite_t* anim_sprite);
-
-void render_animated_sprite(animated_sprite_t* anim_sprite, SDL_Renderer* renderer);
+// For images that are only a part of the texture, like the ones of an atlas
+void create_sprite_from_region(sprite_t* sprite, SDL_Texture* texture, const SDL_Rect* region);
+void render_sprite(sprite_t* sprite, SDL_Renderer* renderer);
 
 #endif
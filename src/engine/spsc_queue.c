@@ -0,0 +1,51 @@
+#include "spsc_queue.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void create_spsc_queue(spsc_queue_t* queue, size_t item_size, unsigned int capacity)
+{
+    assert_panic(capacity == 0 || (capacity & (capacity - 1)) != 0, "The capacity of a queue must be a power of two");
+
+    queue->items = malloc(item_size * capacity);
+    queue->item_size = item_size;
+    queue->capacity = capacity;
+
+    atomic_init(&queue->read_index, 0);
+    atomic_init(&queue->write_index, 0);
+}
+
+void destroy_spsc_queue(spsc_queue_t* queue)
+{
+    free(queue->items);
+    queue->items = NULL;
+}
+
+bool push_to_queue(spsc_queue_t* queue, const void* item)
+{
+    unsigned int write_index = atomic_load_explicit(&queue->write_index, memory_order_relaxed);
+
+    // The consumer must be done with the slot before it's written again
+    if (write_index - atomic_load_explicit(&queue->read_index, memory_order_acquire) == queue->capacity)
+        return false;
+
+    memcpy(queue->items + (write_index & (queue->capacity - 1)) * queue->item_size, item, queue->item_size);
+
+    // Publishes the item along with the index
+    atomic_store_explicit(&queue->write_index, write_index + 1, memory_order_release);
+    return true;
+}
+
+bool pop_from_queue(spsc_queue_t* queue, void* item)
+{
+    unsigned int read_index = atomic_load_explicit(&queue->read_index, memory_order_relaxed);
+
+    if (read_index == atomic_load_explicit(&queue->write_index, memory_order_acquire))
+        return false;
+
+    memcpy(item, queue->items + (read_index & (queue->capacity - 1)) * queue->item_size, queue->item_size);
+
+    atomic_store_explicit(&queue->read_index, read_index + 1, memory_order_release);
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef _SPSC_QUEUE_H
+#define _SPSC_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/*
+ * A ring of fixed size items between exactly one producer thread and one consumer thread
+ * Each side only writes its own index, so nothing ever locks or retries
+ */
+
+typedef struct
+{
+    unsigned char* items;
+    size_t item_size;
+    unsigned int capacity;
+
+    // Both only grow, the difference is the amount of items waiting
+    // Kept on their own cache lines because the threads write them all the time
+    _Alignas(64) _Atomic unsigned int read_index;
+    _Alignas(64) _Atomic unsigned int write_index;
+} spsc_queue_t;
+
+// The capacity must be a power of two
+void create_spsc_queue(spsc_queue_t* queue, size_t item_size, unsigned int capacity);
+void destroy_spsc_queue(spsc_queue_t* queue);
+
+// Only the producer pushes, returns false if the queue is full
+bool push_to_queue(spsc_queue_t* queue, const void* item);
+
+// Only the consumer pops, returns false if the queue is empty
+bool pop_from_queue(spsc_queue_t* queue, void* item);
+
+#endif
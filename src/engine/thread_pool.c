@@ -0,0 +1,134 @@
+#include "thread_pool.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <SDL2/SDL.h>
+
+// The slice [begin, end) is packed as begin in the low and end in the high 32 bits
+typedef struct
+{
+    _Atomic uint64_t slice;
+
+    // Keeping every worker on its own cache line, they are written all the time
+    char padding[64 - sizeof(uint64_t)];
+} worker_slice_t;
+
+typedef struct
+{
+    worker_slice_t* slices;
+    int total_threads;
+
+    task_function function;
+    void* data;
+} pool_t;
+
+typedef struct
+{
+    pool_t* pool;
+    int thread_index;
+} worker_t;
+
+static uint64_t pack_slice(uint32_t begin, uint32_t end)
+{
+    return (uint64_t) end << 32 | begin;
+}
+
+// The owner takes tasks from the end of its slice
+static int pop_task(worker_slice_t* worker)
+{
+    uint64_t slice = atomic_load(&worker->slice);
+
+    for (;;)
+    {
+        uint32_t begin = slice, end = slice >> 32;
+        if (begin >= end) return -1;
+
+        if (atomic_compare_exchange_weak(&worker->slice, &slice, pack_slice(begin, end - 1)))
+            return end - 1;
+    }
+}
+
+// Thieves take the first half, so they rarely fight with the owner
+static bool steal_tasks(worker_slice_t* victim, worker_slice_t* thief)
+{
+    uint64_t slice = atomic_load(&victim->slice);
+
+    for (;;)
+    {
+        uint32_t begin = slice, end = slice >> 32;
+        if (begin >= end) return false;
+
+        uint32_t half = (end - begin + 1) / 2;
+
+        if (atomic_compare_exchange_weak(&victim->slice, &slice, pack_slice(begin + half, end)))
+        {
+            // Nobody can steal from an empty slice, so a plain store is enough
+            atomic_store(&thief->slice, pack_slice(begin, begin + half));
+            return true;
+        }
+    }
+}
+
+static int run_worker(void* data)
+{
+    worker_t* worker = data;
+    pool_t* pool = worker->pool;
+    worker_slice_t* own = &pool->slices[worker->thread_index];
+
+    for (;;)
+    {
+        int task;
+
+        while ((task = pop_task(own)) >= 0)
+            pool->function(task, worker->thread_index, pool->data);
+
+        // Looking for work, starting from the next thread so that thieves spread out
+        bool has_stolen = false;
+
+        for (int i = 1; i < pool->total_threads && !has_stolen; i++)
+            has_stolen = steal_tasks(&pool->slices[(worker->thread_index + i) % pool->total_threads], own);
+
+        // Every slice was empty. A thief might still be holding tasks it just took, but it will run them itself
+        if (!has_stolen) return 0;
+    }
+}
+
+int get_default_thread_count()
+{
+    return SDL_GetCPUCount();
+}
+
+void run_tasks_in_parallel(int total_tasks, int total_threads, task_function function, void* data)
+{
+    if (total_threads <= 0)
+        total_threads = get_default_thread_count();
+
+    pool_t pool = {aligned_alloc(64, total_threads * sizeof(worker_slice_t)), total_threads, function, data};
+    worker_t* workers = malloc(total_threads * sizeof(worker_t));
+    SDL_Thread** threads = malloc(total_threads * sizeof(SDL_Thread*));
+
+    // Splitting the tasks evenly to begin with
+    for (int i = 0; i < total_threads; i++)
+    {
+        uint32_t begin = (int64_t) total_tasks * i / total_threads;
+        uint32_t end = (int64_t) total_tasks * (i + 1) / total_threads;
+
+        atomic_init(&pool.slices[i].slice, pack_slice(begin, end));
+        workers[i] = (worker_t) {&pool, i};
+    }
+
+    // The calling thread works too
+    for (int i = 1; i < total_threads; i++)
+        threads[i] = SDL_CreateThread(run_worker, "worker", &workers[i]);
+
+    run_worker(&workers[0]);
+
+    for (int i = 1; i < total_threads; i++)
+        SDL_WaitThread(threads[i], NULL);
+
+    free(threads);
+    free(workers);
+    free(pool.slices);
+}
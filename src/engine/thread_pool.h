@@ -0,0 +1,19 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+/*
+ * Runs a batch of independent tasks on all cores
+ * Every thread starts with its own slice of task indices and once it runs out, it steals half
+ * of the remaining slice of another thread. Slices are a single atomic value, so nothing ever locks
+ */
+
+// thread_index is in [0, total_threads), useful for per-thread results
+typedef void (*task_function) (int task_index, int thread_index, void* data);
+
+// Blocks until every task has finished, total_threads <= 0 uses one thread per core
+void run_tasks_in_parallel(int total_tasks, int total_threads, task_function function, void* data);
+
+// What total_threads <= 0 resolves to
+int get_default_thread_count();
+
+#endif
@@ -1,4 +1,6 @@
 #include "timers.h"
+#include <stdio.h>
+#include <math.h>
 #include <SDL2/SDL.h>
 
 // Just update's the timer's starting_time nothing fancy
@@ -41,3 +43,92 @@ bool has_reached_interval(interval_t* interval)
 }
 
 
+
+
+void start_phases(phase_timer_t* timer)
+{
+    timer->starting_time = SDL_GetPerformanceCounter();
+    timer->total_phases = 0;
+}
+
+void end_phase(phase_timer_t* timer, const char* name)
+{
+    end_phase_at(timer, name, SDL_GetPerformanceCounter());
+}
+
+void end_phase_at(phase_timer_t* timer, const char* name, uint64_t ending_time)
+{
+    if (timer->total_phases == MAX_PHASES) return;
+
+    timer->names[timer->total_phases] = name;
+    timer->ending_times[timer->total_phases++] = ending_time;
+}
+
+void print_phases(phase_timer_t* timer)
+{
+    double frequency = SDL_GetPerformanceFrequency() / 1000.0;
+    uint64_t previous = timer->starting_time;
+
+    for (int i = 0; i < timer->total_phases; i++)
+    {
+        printf("%-24s %8.2f ms\n", timer->names[i], (timer->ending_times[i] - previous) / frequency);
+        previous = timer->ending_times[i];
+    }
+
+    printf("%-24s %8.2f ms\n", "total", (previous - timer->starting_time) / frequency);
+}
+
+
+void record_latency(latency_histogram_t* histogram, uint32_t milliseconds)
+{
+    histogram->counts[milliseconds < LATENCY_BUCKETS ? milliseconds : LATENCY_BUCKETS]++;
+    histogram->total++;
+
+    if (milliseconds > histogram->max)
+        histogram->max = milliseconds;
+}
+
+uint32_t get_latency_percentile(const latency_histogram_t* histogram, double fraction)
+{
+    // The rank of the latency we are looking for, counting from 1
+    uint32_t rank = (uint32_t) ceil(fraction * histogram->total);
+    uint32_t seen = 0;
+
+    for (uint32_t bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        seen += histogram->counts[bucket];
+        if (seen >= rank && seen > 0) return bucket;
+    }
+
+    return histogram->max;
+}
+
+void print_latency_histogram(const latency_histogram_t* histogram, const char* name)
+{
+    if (histogram->total == 0)
+    {
+        printf("%s: nothing was recorded\n", name);
+        return;
+    }
+
+    printf("%s: %u samples, p50 %u ms, p95 %u ms, p99 %u ms, max %u ms\n", name, histogram->total,
+        get_latency_percentile(histogram, 0.50), get_latency_percentile(histogram, 0.95),
+        get_latency_percentile(histogram, 0.99), histogram->max);
+
+    for (uint32_t first = 0, last = 1; first <= LATENCY_BUCKETS; first = last, last *= 2)
+    {
+        if (last > LATENCY_BUCKETS) last = LATENCY_BUCKETS + 1;
+
+        uint32_t count = 0;
+
+        for (uint32_t bucket = first; bucket < last; bucket++)
+            count += histogram->counts[bucket];
+
+        if (count == 0) continue;
+
+        if (last > LATENCY_BUCKETS)
+            printf("  %4u+ ms      %6u  %5.1f%%\n", first, count, 100.0 * count / histogram->total);
+        else
+            printf("  %4u-%-4u ms  %6u  %5.1f%%\n", first, last - 1, count, 100.0 * count / histogram->total);
+    }
+}
@@ -27,4 +27,45 @@ typedef struct
 void initialize_interval(interval_t* timer, uint32_t interval);
 bool has_reached_interval(interval_t* interval);
 
+
+#define MAX_PHASES 16
+
+// Measures steps that happen one after the other (like the startup of the game) with the performance counter
+typedef struct
+{
+    uint64_t starting_time;
+
+    const char* names[MAX_PHASES];
+    uint64_t ending_times[MAX_PHASES];
+    int total_phases;
+} phase_timer_t;
+
+void start_phases(phase_timer_t* timer);
+
+// The phase lasted from the end of the previous one until now (or until ending_time)
+void end_phase(phase_timer_t* timer, const char* name);
+void end_phase_at(phase_timer_t* timer, const char* name, uint64_t ending_time);
+
+// Prints how long every phase took in milliseconds
+void print_phases(phase_timer_t* timer);
+
+
+// Latencies are counted in buckets of a millisecond, anything slower than a second goes in the last one
+#define LATENCY_BUCKETS 1000
+
+typedef struct
+{
+    uint32_t counts[LATENCY_BUCKETS + 1];
+    uint32_t total;
+    uint32_t max;
+} latency_histogram_t;
+
+void record_latency(latency_histogram_t* histogram, uint32_t milliseconds);
+
+// The latency that the given fraction (e.g. 0.95) of the recorded ones don't exceed
+uint32_t get_latency_percentile(const latency_histogram_t* histogram, double fraction);
+
+// Prints p50, p95 and p99 and a row for every power of two range of milliseconds that isn't empty
+void print_latency_histogram(const latency_histogram_t* histogram, const char* name);
+
 #endif
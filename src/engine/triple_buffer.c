@@ -0,0 +1,51 @@
+#include "triple_buffer.h"
+
+#include <stdlib.h>
+
+#define MIDDLE_IS_FRESH 4
+#define BUFFER_INDEX_MASK 3
+
+void create_triple_buffer(triple_buffer_t* buffer, size_t size)
+{
+    for (int i = 0; i < 3; i++)
+        buffer->buffers[i] = calloc(1, size);
+
+    buffer->back = 0;
+    buffer->front = 2;
+    atomic_init(&buffer->middle, 1);
+}
+
+void destroy_triple_buffer(triple_buffer_t* buffer)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        free(buffer->buffers[i]);
+        buffer->buffers[i] = NULL;
+    }
+}
+
+void* get_back_buffer(triple_buffer_t* buffer)
+{
+    return buffer->buffers[buffer->back];
+}
+
+bool publish_back_buffer(triple_buffer_t* buffer)
+{
+    // The release makes the contents of the back buffer visible before its index
+    int previous = atomic_exchange_explicit(&buffer->middle, buffer->back | MIDDLE_IS_FRESH, memory_order_acq_rel);
+    buffer->back = previous & BUFFER_INDEX_MASK;
+
+    return !(previous & MIDDLE_IS_FRESH);
+}
+
+void* acquire_front_buffer(triple_buffer_t* buffer)
+{
+    // Only the reader clears the flag, so the middle buffer can't stop being fresh before the exchange
+    if (!(atomic_load_explicit(&buffer->middle, memory_order_relaxed) & MIDDLE_IS_FRESH))
+        return NULL;
+
+    int previous = atomic_exchange_explicit(&buffer->middle, buffer->front, memory_order_acq_rel);
+    buffer->front = previous & BUFFER_INDEX_MASK;
+
+    return buffer->buffers[buffer->front];
+}
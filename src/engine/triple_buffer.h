@@ -0,0 +1,42 @@
+#ifndef _TRIPLE_BUFFER_H
+#define _TRIPLE_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/*
+ * Hands whole buffers from one writer thread to one reader thread without ever blocking either of them
+ * The writer fills the back buffer and swaps it with the middle one, the reader swaps its front buffer with the middle one
+ * when something new was published. So the reader always gets the latest buffer and the writer never waits for it
+ */
+
+typedef struct
+{
+    void* buffers[3];
+
+    // Index of the middle buffer, MIDDLE_IS_FRESH is set while the reader hasn't taken it
+    _Atomic int middle;
+
+    // Only touched by their own thread
+    int back;
+    int front;
+} triple_buffer_t;
+
+// The buffers are zeroed
+void create_triple_buffer(triple_buffer_t* buffer, size_t size);
+void destroy_triple_buffer(triple_buffer_t* buffer);
+
+// Writer side, the back buffer belongs to the writer until it's published
+void* get_back_buffer(triple_buffer_t* buffer);
+
+// Returns false if the buffer that was published before was never read, it's the new back buffer then
+// The writer can't know if the reader will get to the one it just published, so anything that must not be lost
+// (like events) has to be in every buffer until the reader confirms it
+bool publish_back_buffer(triple_buffer_t* buffer);
+
+// Reader side, returns NULL if nothing was published since the last call
+// The buffer stays valid until the next call that returns a new one
+void* acquire_front_buffer(triple_buffer_t* buffer);
+
+#endif
@@ -18,3 +18,45 @@ bool chance_one_in(int max)
     // 0 is equally likely
     return rand() % max == 0;
 }
+
+uint32_t next_random(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return *state = x;
+}
+
+int write_varint(uint8_t* buffer, uint32_t value)
+{
+    int length = 0;
+
+    // Seven bits at a time, the highest bit tells if there are more bytes
+    while (value >= 0x80)
+    {
+        buffer[length++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+
+    buffer[length++] = value;
+
+    return length;
+}
+
+int read_varint(const uint8_t* buffer, int length, uint32_t* value)
+{
+    *value = 0;
+
+    for (int i = 0; i < length && i < 5; i++)
+    {
+        *value |= (uint32_t) (buffer[i] & 0x7f) << (7 * i);
+
+        if (!(buffer[i] & 0x80))
+            return i + 1;
+    }
+
+    return 0;
+}
@@ -2,6 +2,7 @@
 #define _MACROS_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <SDL.h>
 
 #define MIN(x, y) (x) < (y) ? (x) : (y)
@@ -13,4 +14,13 @@ void assert_panic(bool condition, const char* message);
 // Functions for randomness
 bool chance_one_in(int max);
 
+// A xorshift generator for when the sequence must be reproducible, state must not be zero
+uint32_t next_random(uint32_t* state);
+
+// Variable length integers (LEB128), values under 128 only take a single byte
+int write_varint(uint8_t* buffer, uint32_t value);
+
+// Returns the amount of bytes read or 0 if the buffer ends before the number does
+int read_varint(const uint8_t* buffer, int length, uint32_t* value);
+
 #endif
@@ -0,0 +1,66 @@
+#include "context.h"
+#include "events.h"
+#include "engine/utils.h"
+
+void subscribe_to_events(uint32_t kinds, event_handler handler)
+{
+    event_bus_t* bus = &ctx.events;
+    assert_panic(bus->total_subscribers == MAX_EVENT_SUBSCRIBERS, "Too many event subscribers, increase MAX_EVENT_SUBSCRIBERS");
+
+    bus->subscribers[bus->total_subscribers++] = (event_subscriber_t) {kinds, handler};
+}
+
+void publish_event(game_event_t event)
+{
+    event_bus_t* bus = &ctx.events;
+
+    // The fog belongs to the rules (the bots ask it in the middle of their turn), so it can't wait for the frame
+    if (event.kind < EVENT_PLAYER_ELIMINATED)
+        mark_fog_tile(event.tile_x, event.tile_y);
+
+    if (event.kind == EVENT_STACK_MOVED || event.kind == EVENT_STACK_MERGED)
+        mark_fog_tile(event.target_x, event.target_y);
+
+    if (bus->total_subscribers == 0 || bus->has_lost_events)
+        return;
+
+    // Everyone will look at the whole game anyway
+    if (bus->write_index - bus->read_index == MAX_FRAME_EVENTS)
+    {
+        publish_reset_event();
+        return;
+    }
+
+    bus->events[bus->write_index++ % MAX_FRAME_EVENTS] = event;
+}
+
+void publish_reset_event()
+{
+    ctx.events.has_lost_events = true;
+    ctx.events.read_index = ctx.events.write_index;
+}
+
+void dispatch_events()
+{
+    event_bus_t* bus = &ctx.events;
+
+    if (bus->has_lost_events)
+    {
+        bus->has_lost_events = false;
+
+        for (int i = 0; i < bus->total_subscribers; i++)
+            bus->subscribers[i].handler(NULL);
+    }
+
+    // Handlers are allowed to publish too, those events are handled in the same frame
+    while (bus->read_index != bus->write_index)
+    {
+        const game_event_t* event = &bus->events[bus->read_index++ % MAX_FRAME_EVENTS];
+
+        for (int i = 0; i < bus->total_subscribers; i++)
+        {
+            if (bus->subscribers[i].kinds & EVENT_BIT(event->kind))
+                bus->subscribers[i].handler(event);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef _EVENTS_H
+#define _EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * The rules publish what changed as events, everything that presents the game (caches, panel, sounds) subscribes to them
+ * Events wait in a ring until the frame dispatches them, so a turn of changes is only looked at once
+ * Games without subscribers (like the tools) don't store anything
+ */
+
+typedef enum
+{
+    EVENT_TILE_KIND_CHANGED,
+    EVENT_TILE_CAPTURED,
+
+    EVENT_STACK_CREATED,
+    EVENT_STACK_MOVED,
+    EVENT_STACK_MERGED,
+    EVENT_STACK_DESTROYED,
+    EVENT_SOLDIERS_TRAINED,
+    EVENT_BATTLE,
+
+    EVENT_PLAYER_ELIMINATED,
+    EVENT_TURN_ENDED,
+
+    NUM_EVENTS,
+} event_kind_e;
+
+#define EVENT_BIT(kind) (1u << (kind))
+#define ALL_EVENTS (EVENT_BIT(NUM_EVENTS) - 1)
+
+// What the value of a moved stack means
+typedef enum
+{
+    MOVE_ON_SURFACE,
+    MOVE_BOARDED_SHIP,
+    MOVE_LANDED,
+} move_surface_e;
+
+typedef struct
+{
+    event_kind_e kind;
+
+    // Moves and merges go from the tile to the target, battles happen on the tile and the attacker came from the target
+    // Players and turns don't have a tile
+    int tile_x, tile_y;
+    int target_x, target_y;
+
+    // Who did it: the capturer, the one that was eliminated or the one that plays after the turn ended
+    int player_id;
+
+    // The previous owner of a captured tile, the move_surface_e of a move or the conqueror of an eliminated player
+    int value;
+} game_event_t;
+
+// Must be a power of two, conquering a whole player at once is the most a single frame publishes
+#define MAX_FRAME_EVENTS 2048
+#define MAX_EVENT_SUBSCRIBERS 8
+
+// The event is NULL when some were lost, the subscriber should look at everything again
+typedef void (*event_handler) (const game_event_t* event);
+
+typedef struct
+{
+    uint32_t kinds;
+    event_handler handler;
+} event_subscriber_t;
+
+typedef struct
+{
+    game_event_t events[MAX_FRAME_EVENTS];
+    unsigned int read_index, write_index;
+    bool has_lost_events;
+
+    event_subscriber_t subscribers[MAX_EVENT_SUBSCRIBERS];
+    int total_subscribers;
+} event_bus_t;
+
+// kinds is a mask of EVENT_BIT, the handler is only called for these
+void subscribe_to_events(uint32_t kinds, event_handler handler);
+
+void publish_event(game_event_t event);
+
+// Everything changed at once (like loading a state), every subscriber gets a NULL event
+void publish_reset_event();
+
+// Called once per frame, before anything is drawn
+void dispatch_events();
+
+#endif
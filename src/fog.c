@@ -0,0 +1,142 @@
+#include <string.h>
+#include "context.h"
+#include "fog.h"
+#include "hex_utils.h"
+#include "tile.h"
+
+#define FOG_SOLDIER_SIGHT 0x80
+
+void mark_fog_tile(int tile_x, int tile_y)
+{
+    if (ctx.fog.is_outdated)
+        return;
+
+    if (ctx.fog.total_changes == FOG_MAX_CHANGES)
+    {
+        mark_fog_outdated();
+        return;
+    }
+
+    ctx.fog.changed_tiles[ctx.fog.total_changes++] = tile_y * TILEMAP_WIDTH + tile_x;
+}
+
+void mark_fog_outdated()
+{
+    ctx.fog.is_outdated = true;
+    ctx.fog.total_changes = 0;
+}
+
+static uint8_t get_sight_source(const tile_t* tile)
+{
+    if (tile->owner_id < 0)
+        return 0;
+
+    return (tile->owner_id + 1) | (tile->soldiers ? FOG_SOLDIER_SIGHT : 0);
+}
+
+// Adds or removes the sight of a single source, only_count skips telling the caches (when everything is counted again)
+static void apply_sight(int tile_x, int tile_y, uint8_t source, int difference, bool only_count)
+{
+    if (!source)
+        return;
+
+    int player_id = (source & ~FOG_SOLDIER_SIGHT) - 1;
+    bool is_viewer = player_id == ctx.fog.viewer_id && !only_count;
+
+    // Tiles see their neighbours, soldiers see as far as they can move
+    int total_offsets = source & FOG_SOLDIER_SIGHT ? TOTAL_HIGHLIGHTED : TOTAL_NEIGHBOURS;
+
+    for (int i = -1; i < total_offsets; i++)
+    {
+        int x = tile_x, y = tile_y;
+
+        // -1 is the tile itself
+        if (i >= 0)
+        {
+            int offset = (tile_y % 2 == 0 ? 0 : total_offsets) + i;
+            int (*offsets)[2] = source & FOG_SOLDIER_SIGHT ? highlighted_offsets : neighbours_offsets;
+
+            x += offsets[offset][0];
+            y += offsets[offset][1];
+        }
+
+        if (!is_valid_tile(x, y)) continue;
+
+        uint8_t* count = &ctx.fog.sight_counts[player_id][y][x];
+        *count += difference;
+
+        // Only the tiles that just appeared or disappeared look different
+        if (is_viewer && *count == (difference > 0 ? 1 : 0))
+        {
+            mark_chunk_outdated(x, y);
+            mark_minimap_tile(x, y);
+        }
+    }
+}
+
+void update_fog()
+{
+    fog_t* fog = &ctx.fog;
+
+    if (!fog->is_outdated && fog->total_changes == 0)
+        return;
+
+    if (fog->is_outdated)
+    {
+        memset(fog->sight_counts, 0, sizeof(fog->sight_counts));
+
+        MAP_FOREACH(x, y)
+        {
+            fog->applied_sources[y][x] = get_sight_source(&ctx.tilemap[y][x]);
+            apply_sight(x, y, fog->applied_sources[y][x], 1, true);
+        }
+
+        fog->is_outdated = false;
+        fog->total_changes = 0;
+
+        mark_all_chunks_outdated();
+        mark_minimap_outdated();
+
+        return;
+    }
+
+    for (int i = 0; i < fog->total_changes; i++)
+    {
+        int x = fog->changed_tiles[i] % TILEMAP_WIDTH, y = fog->changed_tiles[i] / TILEMAP_WIDTH;
+
+        uint8_t* applied = &fog->applied_sources[y][x];
+        uint8_t source = get_sight_source(&ctx.tilemap[y][x]);
+
+        if (source == *applied) continue;
+
+        apply_sight(x, y, *applied, -1, false);
+        apply_sight(x, y, source, 1, false);
+
+        *applied = source;
+    }
+
+    fog->total_changes = 0;
+}
+
+bool is_tile_visible(int player_id, int tile_x, int tile_y)
+{
+    update_fog();
+    return ctx.fog.sight_counts[player_id][tile_y][tile_x] > 0;
+}
+
+void set_fog_viewer(int player_id)
+{
+    if (player_id == ctx.fog.viewer_id)
+        return;
+
+    ctx.fog.viewer_id = player_id;
+
+    // Everything the previous viewer saw is drawn differently now
+    mark_all_chunks_outdated();
+    mark_minimap_outdated();
+}
+
+bool is_tile_visible_to_viewer(int tile_x, int tile_y)
+{
+    return ctx.fog.viewer_id < 0 || is_tile_visible(ctx.fog.viewer_id, tile_x, tile_y);
+}
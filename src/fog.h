@@ -0,0 +1,48 @@
+#ifndef _FOG_H
+#define _FOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Fog of war, every player only sees around the tiles they own and further around their soldiers
+ * Every tile counts how many of each player's tiles and soldiers see it, changed tiles only move their own sight
+ * Changes are collected with mark_fog_tile and applied the next time someone asks what is visible
+ */
+
+// How much the color of fogged tiles is kept, out of 255
+#define FOG_BRIGHTNESS 110
+
+// After this many changes it's cheaper to count everything again (like after loading a savestate)
+#define FOG_MAX_CHANGES 1024
+
+typedef struct
+{
+    // How many sources of each player see the tile
+    uint8_t sight_counts[TOTAL_PLAYERS][TILEMAP_HEIGHT][TILEMAP_WIDTH];
+
+    // The sight that is currently counted for each tile: owner + 1 (0 if nobody) and FOG_SOLDIER_SIGHT if it has soldiers
+    uint8_t applied_sources[TILEMAP_HEIGHT][TILEMAP_WIDTH];
+
+    int changed_tiles[FOG_MAX_CHANGES];
+    int total_changes;
+    bool is_outdated;
+
+    // Whose fog is drawn, -1 shows everything
+    int viewer_id;
+} fog_t;
+
+// Only remembers the tile, so it's cheap to call on every change
+void mark_fog_tile(int tile_x, int tile_y);
+void mark_fog_outdated();
+
+// Applies the changes, queries do it on their own but the caches call it first so they aren't outdated while drawing
+void update_fog();
+
+bool is_tile_visible(int player_id, int tile_x, int tile_y);
+
+// What the renderer uses, every tile is visible when the viewer is -1
+void set_fog_viewer(int player_id);
+bool is_tile_visible_to_viewer(int tile_x, int tile_y);
+
+#endif
@@ -1,3 +1,4 @@
+#include <limits.h>
 #include "hex_utils.h"
 #include "engine/utils.h"
 
@@ -16,29 +17,115 @@ bool is_neighbouring_tile(int source_x, int source_y, int dest_x, int dest_y)
     return false;
 }
 
-bool window_to_tile_position(int* tile_x, int* tile_y, int x, int y)
+// The map repeats every HEX_COLUMN_SPACING x TILE_HEIGHT pixels, starting from the even tile (0, 0)
+// Every pixel of that cell stores which tile it belongs to, relative to the even tile of the cell
+typedef struct
 {
-    // If you're wondering where these came from, I just solved the tile->dest_rect.x, y formula for its index (see create_tile function)
-    *tile_y = y / (TILE_HEIGHT / 2);
+    int8_t offset_x, offset_y;
+} picked_tile_t;
 
-    int offset = *tile_y % 2 == 1 ? 25 : 0;
-    *tile_x = (x - offset) / (TILE_WIDTH + 16);
+static picked_tile_t picking_mask[TILE_HEIGHT][HEX_COLUMN_SPACING];
+static bool is_picking_mask_built = false;
 
-    // Finding coords relative to box for a more precise answer
-    int relative_x = x - (offset + *tile_x * (TILE_WIDTH + 16));
+// How many transparent pixels the tile images have on each side of a row, they're symmetric
+static const int8_t hex_row_insets[TILE_HEIGHT] = {
+    9, 8, 8, 7, 7, 6, 5, 5, 4, 4, 3, 2, 2, 1, 1, 0,
+    0, 1, 1, 2, 2, 3, 4, 4, 5, 5, 6, 7, 7, 8, 8, 9,
+};
 
-    if (relative_x > TILE_WIDTH)
+static bool is_inside_hex(int x, int y)
+{
+    return y >= 0 && y < TILE_HEIGHT && x >= hex_row_insets[y] && x < TILE_WIDTH - hex_row_insets[y];
+}
+
+// A pixel belongs to the tile that is drawn over it, the images are a pixel off in a few places
+// so if it's covered by two tiles or by none of them the closest center wins
+static void build_picking_mask()
+{
+    for (int y = 0; y < TILE_HEIGHT; y++)
     {
-        *tile_y = MAX(*tile_y - 1, 0);
+        for (int x = 0; x < HEX_COLUMN_SPACING; x++)
+        {
+            int closest_distance = INT_MAX;
+            bool is_covered = false;
+
+            // The tile is always one of the 3x3 cells around it, in either row of the cell
+            for (int cell_y = -1; cell_y <= 1; cell_y++)
+            for (int cell_x = -1; cell_x <= 1; cell_x++)
+            for (int row = 0; row < 2; row++)
+            {
+                int left = cell_x * HEX_COLUMN_SPACING + row * HEX_ROW_OFFSET;
+                int top = cell_y * TILE_HEIGHT + row * TILE_HEIGHT / 2;
+
+                // Doubled so that the pixel centers stay integers
+                int distance_x = 2 * (x - left) + 1 - TILE_WIDTH, distance_y = 2 * (y - top) + 1 - TILE_HEIGHT;
+                int distance = distance_x * distance_x + distance_y * distance_y;
+
+                bool is_inside = is_inside_hex(x - left, y - top);
+
+                if ((is_inside && !is_covered) || (is_inside == is_covered && distance < closest_distance))
+                {
+                    closest_distance = distance;
+                    is_covered = is_inside;
+                    picking_mask[y][x] = (picked_tile_t) {cell_x, 2 * cell_y + row};
+                }
+            }
+        }
+    }
+
+    is_picking_mask_built = true;
+}
+
+// Rounds towards negative infinity so that positions left or above the map still land on the right cell
+static int floor_divide(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+bool window_to_tile_position(int* tile_x, int* tile_y, int window_x, int window_y)
+{
+    if (!is_picking_mask_built)
+        build_picking_mask();
 
-        // Exclusive to odd rows (discovered from play testing)
-        if (offset > 0)
-            *tile_x = MIN(TILEMAP_WIDTH, *tile_x + 1);
+    // The side panel covers the rest of the window
+    if (!is_inside_view(&ctx.camera, window_x, window_y))
+    {
+        *tile_x = *tile_y = -1;
+        return false;
     }
 
+    int x, y;
+    screen_to_world(&ctx.camera, window_x, window_y, &x, &y);
+
+    int cell_x = floor_divide(x, HEX_COLUMN_SPACING);
+    int cell_y = floor_divide(y, TILE_HEIGHT);
+
+    picked_tile_t picked = picking_mask[y - cell_y * TILE_HEIGHT][x - cell_x * HEX_COLUMN_SPACING];
+
+    *tile_x = cell_x + picked.offset_x;
+    *tile_y = 2 * cell_y + picked.offset_y;
+
     return is_valid_tile(*tile_x, *tile_y);
 }
 
+tile_range_t get_tiles_in_rect(const SDL_Rect* rect)
+{
+    tile_range_t range;
+
+    // Solved assign_tile_position for the first and last tile that overlap the rect, odd rows reach further right
+    range.first_x = floor_divide(rect->x - TILE_WIDTH - HEX_ROW_OFFSET, HEX_COLUMN_SPACING) + 1;
+    range.last_x = floor_divide(rect->x + rect->w - 1, HEX_COLUMN_SPACING);
+    range.first_y = floor_divide(rect->y - TILE_HEIGHT, TILE_HEIGHT / 2) + 1;
+    range.last_y = floor_divide(rect->y + rect->h - 1, TILE_HEIGHT / 2);
+
+    range.first_x = MAX(range.first_x, 0);
+    range.first_y = MAX(range.first_y, 0);
+    range.last_x = MIN(range.last_x, TILEMAP_WIDTH - 1);
+    range.last_y = MIN(range.last_y, TILEMAP_HEIGHT - 1);
+
+    return range;
+}
+
 bool is_valid_tile(int tile_x, int tile_y)
 {
     return tile_x >= 0 && tile_x < TILEMAP_WIDTH && tile_y >= 0 && tile_y < TILEMAP_HEIGHT;
@@ -55,12 +142,12 @@ void assign_tile_position(int tile_x, int tile_y)
     tile_t* tile = &ctx.tilemap[tile_y][tile_x];
 
     // Some magic numbers here, I didn't want to find a precise formula for it so I'm just doing it manually with trial and error
-    int offset = (tile_y % 2 == 1) ? 25 : 0;
+    int offset = (tile_y % 2 == 1) ? HEX_ROW_OFFSET : 0;
 
-    tile->dest_rect = (SDL_Rect) {offset + tile_x * (TILE_WIDTH + 16), tile_y * TILE_HEIGHT / 2, TILE_WIDTH, TILE_HEIGHT};
+    tile->dest_rect = (SDL_Rect) {offset + tile_x * HEX_COLUMN_SPACING, tile_y * TILE_HEIGHT / 2, TILE_WIDTH, TILE_HEIGHT};
 }
 
-void process_hex_dropdown(dropdown_t* dropdown, dropdown_handler handler)
+void process_hex_dropdown(dropdown_t* dropdown, dropdown_handler handler, uint32_t input_time)
 {
     int choice = get_dropdown_choice(&ctx.game, dropdown);
 
@@ -73,5 +160,5 @@ void process_hex_dropdown(dropdown_t* dropdown, dropdown_handler handler)
     if (!window_to_tile_position(&tile_x, &tile_y, dropdown->background.x, dropdown->background.y))
         return;
 
-    handler(tile_x, tile_y, choice);
+    handler(tile_x, tile_y, choice, input_time);
 }
@@ -44,8 +44,22 @@ static int highlighted_offsets[TOTAL_HIGHLIGHTED * 2][2] = {
 
 bool is_neighbouring_tile(int source_x, int source_y, int dest_x, int dest_y);
 
-// Returns true if the tile is valid else false
-bool window_to_tile_position(int* tile_x, int* tile_y, int x, int y);
+// Goes through the camera, returns true if the tile is valid else false (both are -1 outside of the view)
+bool window_to_tile_position(int* tile_x, int* tile_y, int window_x, int window_y);
+
+// Inclusive bounds of a rectangle of tiles
+typedef struct
+{
+    int first_x, first_y;
+    int last_x, last_y;
+} tile_range_t;
+
+#define RANGE_FOREACH(range, x, y) \
+    for (int y = (range).first_y; y <= (range).last_y; y++) \
+        for (int x = (range).first_x; x <= (range).last_x; x++) \
+
+// Every tile that overlaps the world rect is in the range, it can be empty if the rect is outside of the map
+tile_range_t get_tiles_in_rect(const SDL_Rect* rect);
 
 // Checks if the tile with the specified coordinates is inside the map range
 bool is_valid_tile(int tile_x, int tile_y);
@@ -54,9 +68,10 @@ double get_noise_value(int tile_x, int tile_y);
 void assign_tile_position(int tile_x, int tile_y);
 
 
-typedef void (*dropdown_handler) (int tile_x, int tile_y, int choice_index);
+// The input_time is the timestamp of the click, for measuring the latency
+typedef void (*dropdown_handler) (int tile_x, int tile_y, int choice_index, uint32_t input_time);
 
 // Used for dropdowns that have to do with tiles, must be called after every window click
-void process_hex_dropdown(dropdown_t* dropdown, dropdown_handler handler);
+void process_hex_dropdown(dropdown_t* dropdown, dropdown_handler handler, uint32_t input_time);
 
 #endif
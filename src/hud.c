@@ -0,0 +1,102 @@
+#include <stdio.h>
+
+#include "hud.h"
+#include "context.h"
+
+void create_interface()
+{
+    // Creating the info panel at the right side of the screen
+    create_label(&ctx.player_name, ctx.font, 0);
+    set_transform_position(&ctx.player_name.sprite.transform, VIEWPORT_WIDTH + PANEL_PADDING, 20);
+
+    create_label(&ctx.player_description, ctx.font, 200);
+    set_transform_position(&ctx.player_description.sprite.transform, VIEWPORT_WIDTH + PANEL_PADDING, 210);
+    
+    create_label(&ctx.player_territories, ctx.font, 0);
+    set_transform_position(&ctx.player_territories.sprite.transform, VIEWPORT_WIDTH + PANEL_PADDING, 400);
+
+    create_label(&ctx.player_coins, ctx.font, 0);
+    set_transform_position(&ctx.player_coins.sprite.transform, VIEWPORT_WIDTH + PANEL_PADDING, 425);
+
+    create_label(&ctx.player_income, ctx.font, 0);
+    set_transform_position(&ctx.player_income.sprite.transform, VIEWPORT_WIDTH + PANEL_PADDING, 450);
+
+    create_label(&ctx.player_moves, ctx.font, 0);
+    // +2 because for some reason M appears a bit off in this font
+    set_transform_position(&ctx.player_moves.sprite.transform, VIEWPORT_WIDTH + PANEL_PADDING + 2, 475);
+
+    create_sprite_from_region(&ctx.player_profile, ctx.atlas_texture, &ctx.profiles_region);
+    set_transform_position(&ctx.player_profile.transform, VIEWPORT_WIDTH + PANEL_PADDING, 50);
+
+    // Manually setting scale and source rect dimensions
+    ctx.player_profile.source_rect.w = 64;
+    ctx.player_profile.transform.rect.w = ctx.player_profile.transform.rect.h = 128;
+
+    ctx.panel_rect = (SDL_Rect) {VIEWPORT_WIDTH, 0, PANEL_WIDTH, VIEWPORT_HEIGHT};
+
+    // The minimap takes the rest of the panel under the stats
+    SDL_Rect minimap_area = {VIEWPORT_WIDTH + PANEL_PADDING, 510, PANEL_WIDTH - 2 * PANEL_PADDING, VIEWPORT_HEIGHT - 510 - PANEL_PADDING};
+    create_minimap(ctx.game.renderer, &minimap_area);
+
+    // Creating the dropdowns
+    char farm_text[30], fix_farm_text[30];
+    sprintf(farm_text, "Build Farm (%d Coins)", FARM_COST);
+    sprintf(fix_farm_text, "Fix Farm (%d Coins)", FIX_FARM_COST);
+
+    create_dropdown(&ctx.build_dropdown, ctx.game.renderer, ctx.font, 1, farm_text);
+    create_dropdown(&ctx.fix_farm_dropdown, ctx.game.renderer, ctx.font, 1, fix_farm_text);
+
+    char knight_text[40], saboteur_text[40];
+    sprintf(knight_text, "Train Knight (%d Coins)", soldier_kinds[SOLDIER_KNIGHT].cost);
+    sprintf(saboteur_text, "Train Saboteur (%d Coins)", soldier_kinds[SOLDIER_SABOTEUR].cost);
+
+    create_dropdown(&ctx.train_dropdown, ctx.game.renderer, ctx.font, 2, knight_text, saboteur_text);
+}
+
+static void update_stats()
+{
+    player_t* player = &ctx.players[ctx.current_player_id];
+
+    // Collecting coins and territories to strings
+    char territories[30], coins[20], income[20], moves[20];
+    sprintf(coins, "Coins: %d", player->coins);
+    sprintf(territories, "Territories: %d", player->total_territories);
+    sprintf(income, "Income: %d", player->income);
+    sprintf(moves, "Moves Left: %d", ctx.remaining_moves);
+
+    set_label_content(&ctx.player_coins, ctx.game.renderer, coins);
+    set_label_content(&ctx.player_territories, ctx.game.renderer, territories);
+    set_label_content(&ctx.player_income, ctx.game.renderer, income);
+    set_label_content(&ctx.player_moves, ctx.game.renderer, moves);
+}
+
+void handle_panel_event(const game_event_t* event)
+{
+    // Every action uses a move, so any event can change the numbers of the current player
+    ctx.are_stats_outdated = true;
+
+    if (!event || event->kind == EVENT_TURN_ENDED)
+        ctx.is_panel_outdated = true;
+}
+
+void update_panel()
+{
+    if (ctx.is_panel_outdated)
+    {
+        set_label_content(&ctx.player_name, ctx.game.renderer, player_names[ctx.current_player_id]);
+        set_label_content(&ctx.player_description, ctx.game.renderer, player_descriptions[ctx.current_player_id]);
+
+        ctx.player_profile.source_rect.x = ctx.profiles_region.x + 64 * ctx.current_player_id;
+
+        // Positioning turn arrow
+        int* capital_position = capital_positions[ctx.current_player_id];
+        tile_t* capital = &ctx.tilemap[capital_position[1]][capital_position[0]];
+
+        set_transform_position(&ctx.turn_arrow.transform, capital->dest_rect.x, capital->dest_rect.y - TILE_HEIGHT);
+    }
+
+    if (ctx.are_stats_outdated)
+        update_stats();
+
+    ctx.is_panel_outdated = ctx.are_stats_outdated = false;
+}
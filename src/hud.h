@@ -0,0 +1,17 @@
+#ifndef _HUD_H
+#define _HUD_H
+
+#include "events.h"
+
+/*
+ * The side panel of the game, these functions only present the state
+ * The panel follows the events and is only updated in the frames where something happened
+ */
+
+void create_interface();
+
+// Subscribed to every event, it only marks what has to be updated
+void handle_panel_event(const game_event_t* event);
+void update_panel();
+
+#endif
@@ -0,0 +1,355 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "context.h"
+#include "lockstep.h"
+#include "engine/utils.h"
+
+// Magic, version, player id, total players and the seed
+#define HELLO_SIZE 11
+
+static void write_u32(uint8_t* buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        buffer[i] = value >> (8 * i);
+}
+
+static uint32_t read_u32(const uint8_t* buffer)
+{
+    return buffer[0] | buffer[1] << 8 | buffer[2] << 16 | (uint32_t) buffer[3] << 24;
+}
+
+static void configure_socket(int socket_fd)
+{
+    // Actions are tiny, so they should leave right away instead of waiting to be merged
+    int enabled = 1;
+    setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+}
+
+// Only used during the handshake, the game loop must never wait for the network
+static void send_all(int socket_fd, const uint8_t* data, int length)
+{
+    while (length > 0)
+    {
+        int sent = send(socket_fd, data, length, MSG_NOSIGNAL);
+        assert_panic(sent <= 0, "Lost the connection while setting up the game");
+
+        data += sent;
+        length -= sent;
+    }
+}
+
+static void receive_all(int socket_fd, uint8_t* data, int length)
+{
+    while (length > 0)
+    {
+        int received = recv(socket_fd, data, length, 0);
+        assert_panic(received <= 0, "Lost the connection while setting up the game");
+
+        data += received;
+        length -= received;
+    }
+}
+
+static void add_peer(int socket_fd)
+{
+    peer_t* peer = &ctx.lockstep.peers[ctx.lockstep.total_peers++];
+
+    peer->socket = socket_fd;
+    peer->incoming_length = peer->outgoing_length = 0;
+
+    fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) | O_NONBLOCK);
+}
+
+void host_lockstep_game(int port, int total_players, int seed)
+{
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    assert_panic(listener < 0, "Couldn't create the server socket");
+
+    int enabled = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+
+    struct sockaddr_in address = {0};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    assert_panic(bind(listener, (struct sockaddr*) &address, sizeof(address)) < 0, "Couldn't bind the server socket, is the port already used?");
+    assert_panic(listen(listener, MAX_PEERS) < 0, "Couldn't listen for players");
+
+    ctx.lockstep.is_active = true;
+    ctx.lockstep.is_host = true;
+    ctx.lockstep.local_player_id = 0;
+
+    printf("Waiting for %d more players on port %d\n", total_players - 1, port);
+
+    // Players get their ids in the order they join, the host is always the first one
+    for (int player_id = 1; player_id < total_players; player_id++)
+    {
+        int client = accept(listener, NULL, NULL);
+        assert_panic(client < 0, "Failed to accept a player");
+
+        configure_socket(client);
+
+        uint8_t hello[HELLO_SIZE];
+        memcpy(hello, LOCKSTEP_MAGIC, 4);
+        hello[4] = LOCKSTEP_VERSION;
+        hello[5] = player_id;
+        hello[6] = total_players;
+        write_u32(hello + 7, seed);
+
+        send_all(client, hello, HELLO_SIZE);
+        add_peer(client);
+
+        printf("%s has joined the game\n", player_names[player_id]);
+    }
+
+    close(listener);
+}
+
+int join_lockstep_game(const char* address)
+{
+    char host[256];
+    const char* separator = strrchr(address, ':');
+
+    assert_panic(!separator || separator - address >= sizeof(host), "The address should look like host:port");
+
+    memcpy(host, address, separator - address);
+    host[separator - address] = '\0';
+
+    struct addrinfo hints = {0}, *results;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    assert_panic(getaddrinfo(host, separator + 1, &hints, &results) != 0, "Couldn't find the host");
+
+    int server = -1;
+
+    for (struct addrinfo* result = results; result; result = result->ai_next)
+    {
+        server = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+        if (server < 0) continue;
+
+        if (connect(server, result->ai_addr, result->ai_addrlen) == 0) break;
+
+        close(server);
+        server = -1;
+    }
+
+    freeaddrinfo(results);
+    assert_panic(server < 0, "Couldn't connect to the host");
+
+    configure_socket(server);
+
+    uint8_t hello[HELLO_SIZE];
+    receive_all(server, hello, HELLO_SIZE);
+
+    assert_panic(memcmp(hello, LOCKSTEP_MAGIC, 4) != 0 || hello[4] != LOCKSTEP_VERSION, "The host is running an incompatible version of the game");
+
+    ctx.lockstep.is_active = true;
+    ctx.lockstep.is_host = false;
+    ctx.lockstep.local_player_id = hello[5];
+    ctx.starting_players = hello[6];
+
+    add_peer(server);
+
+    printf("Joined the game as %s\n", player_names[ctx.lockstep.local_player_id]);
+
+    return (int) read_u32(hello + 7);
+}
+
+bool is_local_turn()
+{
+    return !ctx.lockstep.is_active || ctx.current_player_id == ctx.lockstep.local_player_id;
+}
+
+static void flush_peer(peer_t* peer)
+{
+    while (peer->outgoing_length > 0)
+    {
+        int sent = send(peer->socket, peer->outgoing, peer->outgoing_length, MSG_NOSIGNAL);
+
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        assert_panic(sent <= 0, "Lost the connection to another player");
+
+        peer->outgoing_length -= sent;
+        memmove(peer->outgoing, peer->outgoing + sent, peer->outgoing_length);
+    }
+}
+
+static void queue_record(peer_t* peer, const uint8_t* record, int length)
+{
+    assert_panic(peer->outgoing_length + length > LOCKSTEP_BUFFER_SIZE, "Another player isn't receiving any data");
+
+    memcpy(peer->outgoing + peer->outgoing_length, record, length);
+    peer->outgoing_length += length;
+
+    flush_peer(peer);
+}
+
+void send_action(const action_t* action, bool has_ended_turn)
+{
+    if (!ctx.lockstep.is_active) return;
+
+    uint8_t record[MAX_ENCODED_ACTION + 4];
+    int length = encode_action(action, record);
+
+    if (has_ended_turn)
+    {
+        record[0] |= RECORD_HAS_CHECKSUM;
+        write_u32(record + length, compute_state_checksum());
+
+        length += 4;
+    }
+
+    for (int i = 0; i < ctx.lockstep.total_peers; i++)
+        queue_record(&ctx.lockstep.peers[i], record, length);
+}
+
+static void report_desync(unsigned int turn, const char* reason)
+{
+    printf("The game is out of sync after turn %u: %s\n", turn, reason);
+    exit(EXIT_FAILURE);
+}
+
+static void apply_remote_action(const action_t* action, bool has_checksum, uint32_t checksum)
+{
+    unsigned int turn = ctx.turn;
+
+    if (is_local_turn())
+        report_desync(turn, "received an action during our own turn");
+
+    if (!apply_action(action))
+        report_desync(turn, "received an action that the rules don't allow");
+
+    if ((ctx.turn != turn) != has_checksum)
+        report_desync(turn, "players disagree about when the turn ended");
+
+    if (has_checksum && checksum != compute_state_checksum())
+        report_desync(turn, "the game states are different");
+}
+
+static void process_records(int peer_index)
+{
+    peer_t* peer = &ctx.lockstep.peers[peer_index];
+    int offset = 0;
+
+    while (offset < peer->incoming_length)
+    {
+        const uint8_t* record = peer->incoming + offset;
+        int available = peer->incoming_length - offset;
+
+        action_t action;
+        int read = decode_action(&action, record, available);
+
+        assert_panic(read < 0, "Received invalid data from another player");
+        if (read == 0) break;
+
+        bool has_checksum = record[0] & RECORD_HAS_CHECKSUM;
+        int record_length = read + (has_checksum ? 4 : 0);
+
+        // The checksum hasn't arrived yet
+        if (available < record_length) break;
+
+        // Clients can only act during their own turn, the host's peers are ordered by player id
+        if (ctx.lockstep.is_host && ctx.current_player_id != peer_index + 1)
+            report_desync(ctx.turn, "a player acted outside of his turn");
+
+        apply_remote_action(&action, has_checksum, has_checksum ? read_u32(record + read) : 0);
+
+        // The host passes everything on to the other clients
+        if (ctx.lockstep.is_host)
+        {
+            for (int i = 0; i < ctx.lockstep.total_peers; i++)
+            {
+                if (i != peer_index)
+                    queue_record(&ctx.lockstep.peers[i], record, record_length);
+            }
+        }
+
+        offset += record_length;
+    }
+
+    peer->incoming_length -= offset;
+    memmove(peer->incoming, peer->incoming + offset, peer->incoming_length);
+}
+
+void poll_lockstep()
+{
+    if (!ctx.lockstep.is_active) return;
+
+    for (int i = 0; i < ctx.lockstep.total_peers; i++)
+    {
+        peer_t* peer = &ctx.lockstep.peers[i];
+
+        flush_peer(peer);
+
+        for (;;)
+        {
+            int free_space = LOCKSTEP_BUFFER_SIZE - peer->incoming_length;
+            if (free_space == 0) break;
+
+            int received = recv(peer->socket, peer->incoming + peer->incoming_length, free_space, 0);
+
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            assert_panic(received <= 0, "Another player has left the game");
+
+            peer->incoming_length += received;
+        }
+
+        process_records(i);
+    }
+}
+
+static uint32_t hash_value(uint32_t hash, uint32_t value)
+{
+    // FNV-1a, one byte at a time
+    for (int i = 0; i < 4; i++)
+    {
+        hash ^= (value >> (8 * i)) & 0xff;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+uint32_t compute_state_checksum()
+{
+    uint32_t hash = 2166136261u;
+
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+
+        hash = hash_value(hash, tile->kind | (tile->owner_id + 1) << 8 | tile->is_capital << 16);
+
+        if (tile->soldiers)
+            hash = hash_value(hash, tile->soldiers->kind | tile->soldiers->units << 8 | tile->soldiers->remaining_moves << 24);
+    }
+
+    for (int i = 0; i < ctx.starting_players; i++)
+    {
+        player_t* player = &ctx.players[i];
+
+        hash = hash_value(hash, player->is_dead);
+        hash = hash_value(hash, player->coins);
+        hash = hash_value(hash, player->income);
+        hash = hash_value(hash, player->total_territories);
+        hash = hash_value(hash, player->total_units);
+        hash = hash_value(hash, player->total_cities);
+        hash = hash_value(hash, player->total_farms);
+    }
+
+    hash = hash_value(hash, ctx.current_player_id);
+    hash = hash_value(hash, ctx.remaining_moves);
+    hash = hash_value(hash, ctx.turn);
+
+    return hash_value(hash, ctx.random_state);
+}
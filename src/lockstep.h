@@ -0,0 +1,68 @@
+#ifndef _LOCKSTEP_H
+#define _LOCKSTEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "actions.h"
+
+/*
+ * Network games run the whole simulation on every machine and only send the player actions
+ * The host relays everything between the clients, so they only need a single connection
+ * Actions are sent as soon as they happen and nobody waits for an answer,
+ * the player whose turn ended just attaches a checksum that everyone else compares with their own state
+ */
+
+#define LOCKSTEP_MAGIC "HXLS"
+#define LOCKSTEP_VERSION 1
+
+#define LOCKSTEP_BUFFER_SIZE 4096
+
+// The host talks to everyone else
+#define MAX_PEERS (TOTAL_PLAYERS - 1)
+
+// Set on the first byte of an action that ended the turn, 4 bytes of checksum follow it
+#define RECORD_HAS_CHECKSUM 0x80
+
+typedef struct
+{
+    int socket;
+
+    uint8_t incoming[LOCKSTEP_BUFFER_SIZE];
+    int incoming_length;
+
+    uint8_t outgoing[LOCKSTEP_BUFFER_SIZE];
+    int outgoing_length;
+} peer_t;
+
+typedef struct
+{
+    bool is_active;
+    bool is_host;
+
+    // Every machine controls a single player
+    int local_player_id;
+
+    // The host has a peer for every client while clients only talk to the host
+    peer_t peers[MAX_PEERS];
+    int total_peers;
+} lockstep_t;
+
+// Waits until every other player has joined and sends them the game settings
+void host_lockstep_game(int port, int total_players, int seed);
+
+// Connects to a host, address is in "host:port" form. Returns the map seed that the host picked
+int join_lockstep_game(const char* address);
+
+// Always true for local games
+bool is_local_turn();
+
+// Doesn't do anything for local games
+void send_action(const action_t* action, bool has_ended_turn);
+
+// Sends any pending data and applies the actions that have arrived, must be called every frame
+void poll_lockstep();
+
+// A hash of everything that has to be identical between the machines
+uint32_t compute_state_checksum();
+
+#endif
@@ -1,522 +1,409 @@
 #include <stdio.h>
+#include <ctype.h>
 #include <time.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
 #include "context.h"
 #include "hex_utils.h"
+#include "rules.h"
+#include "hud.h"
+#include "actions.h"
+#include "lockstep.h"
+#include "map_pack.h"
+#include "scenario.h"
+#include "simulation.h"
+#include "validation.h"
+#include "engine/assets.h"
 #include "engine/utils.h"
 #include "libs/noise/open-simplex.h"
 
-// Places grass at the specified position and removes visual glitches
-void place_grass(int tile_x, int tile_y)
+// Handles soldier selection and attacks
+// The input_time is the timestamp of the click, the latency is measured until a frame shows what it did
+void handle_click(int tile_x, int tile_y, uint32_t input_time)
 {
-    create_tile(tile_x, tile_y, TILE_GRASS);
+    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
 
-    if (is_valid_tile(tile_x, tile_y - 2) && ctx.tilemap[tile_y - 2][tile_x].kind == TILE_COAST)
+    // Deselect if the player presses the selected soldiers
+    if (tile->soldiers == ctx.selected_soldiers)
     {
-        set_tile_kind(tile_x, tile_y - 2, TILE_GRASS);
-    }
-}
-
-void create_interface()
-{
-    // Creating the info panel at the right side of the screen
-    create_label(&ctx.player_name, ctx.font, 0);
-    set_transform_position(&ctx.player_name.sprite.transform, TOTAL_TILEMAP_WIDTH + PANEL_PADDING, 20);
-
-    create_label(&ctx.player_description, ctx.font, 200);
-    set_transform_position(&ctx.player_description.sprite.transform, TOTAL_TILEMAP_WIDTH + PANEL_PADDING, 210);
-    
-    create_label(&ctx.player_territories, ctx.font, 0);
-    set_transform_position(&ctx.player_territories.sprite.transform, TOTAL_TILEMAP_WIDTH + PANEL_PADDING, 400);
-
-    create_label(&ctx.player_coins, ctx.font, 0);
-    set_transform_position(&ctx.player_coins.sprite.transform, TOTAL_TILEMAP_WIDTH + PANEL_PADDING, 425);
-
-    create_label(&ctx.player_income, ctx.font, 0);
-    set_transform_position(&ctx.player_income.sprite.transform, TOTAL_TILEMAP_WIDTH + PANEL_PADDING, 450);
-
-    create_label(&ctx.player_moves, ctx.font, 0);
-    // +2 because for some reason M appears a bit off in this font
-    set_transform_position(&ctx.player_moves.sprite.transform, TOTAL_TILEMAP_WIDTH + PANEL_PADDING + 2, 475);
-
-    create_sprite(&ctx.player_profile, load_texture("res/profiles.png"));
-    set_transform_position(&ctx.player_profile.transform, TOTAL_TILEMAP_WIDTH + PANEL_PADDING, 50);
-
-    // Manually setting scale and source rect dimensions
-    ctx.player_profile.source_rect.w = 64;
-    ctx.player_profile.transform.rect.w = ctx.player_profile.transform.rect.h = 128;
+        clear_selected_soldiers();
+        track_input_latency(&ctx.game, input_time);
 
-    ctx.panel_rect = (SDL_Rect) {TOTAL_TILEMAP_WIDTH, 0, PANEL_WIDTH, TOTAL_TILEMAP_HEIGHT};
+        return;
+    }
 
-    // Creating the dropdowns
-    char farm_text[30], fix_farm_text[30];
-    sprintf(farm_text, "Build Farm (%d Coins)", FARM_COST);
-    sprintf(fix_farm_text, "Fix Farm (%d Coins)", FIX_FARM_COST);
+    if (!ctx.selected_soldiers)
+    {
+        // Other machines control this player right now
+        if (!is_local_turn() || tile->soldiers->remaining_moves == 0) return;
 
-    create_dropdown(&ctx.build_dropdown, ctx.game.renderer, ctx.font, 1, farm_text);
-    create_dropdown(&ctx.fix_farm_dropdown, ctx.game.renderer, ctx.font, 1, fix_farm_text);
+        select_soldiers(tile->soldiers, tile_x, tile_y);
 
-    char knight_text[40], saboteur_text[40];
-    sprintf(knight_text, "Train Knight (%d Coins)", SOLDIER_COSTS[SOLDIER_KNIGHT]);
-    sprintf(saboteur_text, "Train Saboteur (%d Coins)", SOLDIER_COSTS[SOLDIER_SABOTEUR]);
+        if (ctx.selected_soldiers)
+            track_input_latency(&ctx.game, input_time);
+    }
+    // Move soldiers, the latency is tracked once the move is applied
+    else
+    {
+        action_t move = {ACTION_MOVE, ctx.selected_x, ctx.selected_y, tile_x, tile_y, .input_time = input_time};
+        submit_action(&move);
 
-    create_dropdown(&ctx.train_dropdown, ctx.game.renderer, ctx.font, 2, knight_text, saboteur_text);
+        clear_selected_soldiers();
+    }
 }
 
-void update_stats()
+void handle_build(int tile_x, int tile_y, int choice, uint32_t input_time)
 {
-    player_t* player = &ctx.players[ctx.current_player_id];
-
-    // Calculating income here
-    player->income = FARM_INCOME * player->total_farms + CITY_INCOME * player->total_cities
-        - (player->total_units / 10) * COST_PER_10_UNITS + player->total_territories / TERRITORIES_PER_COIN;
-
-    // Collecting coins and territories to strings
-    char territories[30], coins[20], income[20];
-    sprintf(coins, "Coins: %d", ctx.players[ctx.current_player_id].coins);
-    sprintf(territories, "Territories: %d", ctx.players[ctx.current_player_id].total_territories);
-    sprintf(income, "Income: %d", ctx.players[ctx.current_player_id].income);
+    switch (choice)
+    {
+        // Farm creation
+        case 0:
+            submit_action(&(action_t) {ACTION_BUILD_FARM, tile_x, tile_y, .input_time = input_time});
 
-    set_label_content(&ctx.player_coins, ctx.game.renderer, coins);
-    set_label_content(&ctx.player_territories, ctx.game.renderer, territories);
-    set_label_content(&ctx.player_income, ctx.game.renderer, income);
+            break;
+    }
 }
 
-void update_interface()
+void handle_farm_fix(int tile_x, int tile_y, int choice, uint32_t input_time)
 {
-    set_label_content(&ctx.player_name, ctx.game.renderer, player_names[ctx.current_player_id]);
-    set_label_content(&ctx.player_description, ctx.game.renderer, player_descriptions[ctx.current_player_id]);
-
-    ctx.player_profile.source_rect.x = 64 * ctx.current_player_id;
-    update_stats();
+    submit_action(&(action_t) {ACTION_FIX_FARM, tile_x, tile_y, .input_time = input_time});
 }
 
-void update_moves_label()
+void handle_train(int tile_x, int tile_y, int choice, uint32_t input_time)
 {
-    char moves_text[20];
-    sprintf(moves_text, "Moves Left: %d", ctx.remaining_moves);
-
-    set_label_content(&ctx.player_moves, ctx.game.renderer, moves_text);
+    // Using choice index as enum
+    submit_action(&(action_t) {ACTION_TRAIN, tile_x, tile_y, .choice = choice, .input_time = input_time});
 }
 
-void create_tilemap()
+// Sounds, effects and the slides of the stacks only follow the events, the rules don't know about them
+void handle_effect_event(const game_event_t* event)
 {
-    MAP_FOREACH(x, y)
-    {
-        // Using simplex noise to find out what the tile will be
-        double value = get_noise_value(x, y);
-        double bottom = get_noise_value(x, y + 2);
-        double top = get_noise_value(x, y - 2);
+    if (!event) return;
 
-        // All bottom tiles should look like coasts
-        if (value > LAND_START && y > TILEMAP_HEIGHT - 3)
-        {
-            create_tile(x, y, TILE_COAST);
-        }
-        else if (value > LAND_START && bottom < LAND_START)
-        {
-            create_tile(x, y, chance_one_in(8) ? TILE_PORT : TILE_COAST);
-        }
-        else if (value > LAND_START && top < LAND_START && chance_one_in(8))
-        {
-            create_tile(x, y, TILE_PORT);
-        }
-        // Forests
-        else if (value > FOREST_START)
-        {
-            create_tile(x, y, TILE_FOREST);
-        }
-        // Threshold for dirt placement
-        else if (value > LAND_START)
-        {
-            create_tile(x, y, chance_one_in(7) ? TILE_FOREST : TILE_GRASS);
-        }
-        else if (chance_one_in(10))
-        {
-            create_tile(x, y, TILE_FISH);
-        }
-        else
-        {
-            // Make sure that water tiles have a dest_rect position too
-            assign_tile_position(x, y);
-            set_tile_kind(x, y, TILE_WATER);
-        }
-    }
+    tile_t* tile = &ctx.tilemap[event->tile_y][event->tile_x];
 
-    // Generating the capitals at the four map edges (if no land is there, it will be generated with a port too)
-    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+    switch (event->kind)
     {
-        int tile_x = capital_positions[player_id][0];
-        int tile_y = capital_positions[player_id][1];
-
-        tile_t* capital = &ctx.tilemap[tile_y][tile_x];
-
-        // Making sure that it's a grass tile
-        if (is_water(tile_x, tile_y))
-            place_grass(tile_x, tile_y);
-
-        capture_tile(tile_x, tile_y, player_id);
-        create_city(tile_x, tile_y);
-
-        capital->is_capital = true;
-        capital->soldiers = create_soldiers(tile_x, tile_y, SOLDIER_KNIGHT);
-        capital->soldiers->remaining_moves = SOLDIER_MOVES[SOLDIER_KNIGHT];
-        
-        ctx.players[player_id].total_units = KNIGHTS_PER_TRAIN;
-        ctx.players[player_id].coins = STARTING_COINS;
-
-        FOREACH_OFFSET(tile_y, TOTAL_NEIGHBOURS, j) 
+        case EVENT_STACK_MOVED:
         {
-            int x = tile_x + neighbours_offsets[j][0];
-            int y = tile_y + neighbours_offsets[j][1];
+            // Another action of the same frame might have moved it again already
+            tile_t* target = &ctx.tilemap[event->target_y][event->target_x];
 
-            if (!is_valid_tile(x, y)) continue;
-            tile_t* neighbour = &ctx.tilemap[y][x];
+            if (target->soldiers)
+                slide_soldiers(target->soldiers, tile, ctx.game.frame_time);
 
-            // Make sure that land exists
-            if (is_water(x, y))
+            if (event->value == MOVE_BOARDED_SHIP)
             {
-                place_grass(x, y);
+                // The effects would show what the fog hides, the sounds can't tell where it happened
+                if (is_tile_visible_to_viewer(event->target_x, event->target_y))
+                    play_effect(&ctx.effects, EFFECT_SPLASH, target->dest_rect.x + TILE_WIDTH / 2, target->dest_rect.y + TILE_HEIGHT / 2, splash_color);
 
-                // Fix some visual glitches
-                if (y > TILEMAP_HEIGHT - 3 || y > tile_y && is_valid_tile(x, y + 2) && is_water(x, y + 2))
-                    set_tile_kind(x, y, TILE_COAST);
+                play_audio(ctx.shipbell_sfx);
             }
+            else if (event->value == MOVE_ON_SURFACE)
+                play_audio(ctx.dirt_sfx);
 
-            capture_tile(x, y, player_id);
+            break;
         }
 
-        // Generating a port at the bottom and at the top tile if the player needs a way to exit his isolated island 
-        // NOTE: The player can still be blocked, but the probability is really low
-        if (is_valid_tile(tile_x, tile_y + 4) && is_water(tile_x, tile_y + 4))
-            set_tile_kind(tile_x, tile_y + 2, TILE_PORT);
-    
-        if (is_valid_tile(tile_x, tile_y - 4) && is_water(tile_x, tile_y - 4))
-            set_tile_kind(tile_x, tile_y - 2, TILE_PORT);
-    }
-}
+        case EVENT_SOLDIERS_TRAINED:
+            play_audio(ctx.military_sfx);
+            break;
 
-void next_turn()
-{
-    // Applying old player's income
-    player_t* old_player = &ctx.players[ctx.current_player_id];
-    old_player->coins += old_player->income;
+        case EVENT_BATTLE:
+            // The attacker won and moved in
+            if (tile->soldiers && tile->owner_id == event->player_id)
+                slide_soldiers(tile->soldiers, &ctx.tilemap[event->target_y][event->target_x], ctx.game.frame_time);
 
-    // Checking if the old player is the richest
-    bool was_richest = true;
+            if (is_tile_visible_to_viewer(event->tile_x, event->tile_y))
+                play_effect(&ctx.effects, EFFECT_EXPLOSION, tile->dest_rect.x + TILE_WIDTH / 2, tile->dest_rect.y + TILE_HEIGHT / 2, (SDL_Color) {255, 255, 255, 255});
 
-    for (int i = 0; i < ctx.starting_players; i++)
-    {
-        if (ctx.players[i].income > old_player->income)
-        {
-            was_richest = false;
-            break;
-        }
-    }
+            play_audio(ctx.cannon_sfx);
 
-    // Resetting soldier moves
-    MAP_FOREACH(x, y)
-    {
-        tile_t* tile = &ctx.tilemap[y][x];
-        if (tile->owner_id != ctx.current_player_id) continue;
+            break;
 
-        // Make it probable that the richest player's farms get broken, so that the game becomes more balanced
-        if (tile->kind == TILE_FARM && was_richest && old_player->income > 20 && chance_one_in(15))
-        {
-            set_tile_kind(x, y, TILE_BROKEN_FARM);
-        }
-        else if (tile->kind == TILE_BROKEN_FARM)
+        case EVENT_TILE_CAPTURED:
         {
-            old_player->total_farms--;
-            set_tile_kind(x, y, TILE_GRASS);
-        }
+            if (!is_tile_visible_to_viewer(event->tile_x, event->tile_y)) break;
 
-        if (tile->soldiers)
-            tile->soldiers->remaining_moves = SOLDIER_MOVES[tile->soldiers->kind];
-    }
+            // Using the color of the borders, only more opaque
+            SDL_Color color = player_colors[event->player_id];
+            color.a = 200;
 
-    // Going to the next player
-    ctx.current_player_id++;
-    ctx.selected_soldiers = NULL;
-    ctx.remaining_moves = MOVES_PER_TURN;
+            play_effect(&ctx.effects, EFFECT_CAPTURE_FLASH, tile->dest_rect.x + TILE_WIDTH / 2, tile->dest_rect.y + TILE_HEIGHT / 2, color);
 
-    update_moves_label();
+            break;
+        }
 
-    if (ctx.current_player_id > ctx.starting_players - 1)
-        ctx.current_player_id = 0;
+        default:
+            break;
+    }
+}
 
-    // Skip if the player is dead
-    if (ctx.players[ctx.current_player_id].is_dead) return next_turn();
+#define EFFECT_EVENTS (EVENT_BIT(EVENT_STACK_MOVED) | EVENT_BIT(EVENT_SOLDIERS_TRAINED) | EVENT_BIT(EVENT_BATTLE) | EVENT_BIT(EVENT_TILE_CAPTURED))
 
-    // Check if the player is bankrupt
-    if (ctx.players[ctx.current_player_id].coins < 0)
-    {
-        ctx.players[ctx.current_player_id].coins = 0;
+// Set by --map-pack, the map is copied from there instead of being generated
+map_pack_t map_pack;
+int map_index = 0;
 
-        MAP_FOREACH(x, y)
-        {
-            tile_t* tile = &ctx.tilemap[y][x];
+// Set by --scenario, the whole position is loaded from a text file (see scenario.h)
+const char* scenario_path = NULL;
 
-            if (tile->owner_id == ctx.current_player_id && tile->soldiers != NULL)
-                destroy_soldiers(tile->soldiers);
-        }
-    }
+// Set by --startup-report, measured from the start of main until the first frame is on screen
+bool show_startup_report = false;
+phase_timer_t startup;
+uint64_t asset_decoding_ticks;
 
-    update_interface();
+// Set by --latency-report, the histogram of the time from an input until the frame that shows it is printed at the end
+bool show_latency_report = false;
 
-    // Positioning turn arrow
-    int* capital_position = capital_positions[ctx.current_player_id];
+void initialize_context()
+{
+    // Network players need to know which window is theirs
+    char title[60] = "Hextinction";
 
-    tile_t* capital = &ctx.tilemap[capital_position[1]][capital_position[0]];
+    if (ctx.lockstep.is_active)
+        sprintf(title, "Hextinction (%s)", player_names[ctx.lockstep.local_player_id]);
 
-    set_transform_position(&ctx.turn_arrow.transform, capital->dest_rect.x, capital->dest_rect.y - TILE_HEIGHT);
-}
+    // The files are decoded on other threads while the window is being created
+    asset_loader_t loader = {0};
+    SDL_Rect explosion_region, arrow_region;
 
-void generate_unclaimed_cities()
-{
-    int current_x = 0;
-    int current_y = 0;
+    // Packed into one texture so that the renderer can batch the whole map
+    add_atlas_asset(&loader, "res/tilemap.png", &ctx.tilemap_region);
+    add_atlas_asset(&loader, "res/border.png", &ctx.border_region);
+    add_atlas_asset(&loader, "res/soldiers.png", &ctx.soldiers_region);
+    add_atlas_asset(&loader, "res/profiles.png", &ctx.profiles_region);
+    add_atlas_asset(&loader, "res/explosion.png", &explosion_region);
+    add_atlas_asset(&loader, "res/arrow.png", &arrow_region);
 
-    while (current_y < TILEMAP_HEIGHT - 3)
-    {
-        int offset_x = rand() % 2;
-        int offset_y = rand() % 3;
+    add_audio_asset(&loader, "res/dirt.wav", &ctx.dirt_sfx);
+    add_audio_asset(&loader, "res/cannon.wav", &ctx.cannon_sfx);
+    add_audio_asset(&loader, "res/shipbell.wav", &ctx.shipbell_sfx);
+    add_audio_asset(&loader, "res/military.wav", &ctx.military_sfx);
 
-        tile_t* tile = &ctx.tilemap[current_y + offset_y][current_x + offset_x];
+    start_loading_assets(&loader);
 
-        // Spawn only in empty grass/forest tiles
-        if (tile->owner_id < 0 && tile->kind == TILE_GRASS || tile->kind == TILE_FOREST)
-        {
-            create_city(current_x + offset_x, current_y + offset_y);
-        }
+    // The frames follow the display so that the stacks slide smoothly, the rules don't depend on the frame rate
+    create_game(&ctx.game, title, VIEWPORT_WIDTH + PANEL_WIDTH, VIEWPORT_HEIGHT, 0);
+    create_camera(&ctx.camera, VIEWPORT_WIDTH, VIEWPORT_HEIGHT, TOTAL_TILEMAP_WIDTH, TOTAL_TILEMAP_HEIGHT);
+    end_phase(&startup, "window and renderer");
 
-        // This algorithm moves in "chunks" and just determines some offset for a more organic result
-        current_x += 3;
+    ctx.font = TTF_OpenFont("res/free_mono.ttf", 18);
+    end_phase(&startup, "font");
 
-        if (current_x > TILEMAP_WIDTH - 2)
-        {
-            current_x = 0;
-            current_y += 5;
-        }
-    }
-}
+    finish_loading_assets(&loader, ctx.game.renderer);
+    end_phase(&startup, "waiting for assets");
 
-void decrement_move()
-{
-    ctx.remaining_moves--;
+    ctx.atlas_texture = loader.atlas;
 
-    // Check if the turn has ended
-    if (ctx.remaining_moves == 0)
-        next_turn();
+    // There is no art for the splashes, they are small explosions colored like the sea
+    set_effect_kind(&ctx.effects, EFFECT_EXPLOSION, &(effect_kind_t) {explosion_region, 9, 100, 2});
+    set_effect_kind(&ctx.effects, EFFECT_CAPTURE_FLASH, &(effect_kind_t) {ctx.border_region, 1, 400, 1, true});
+    set_effect_kind(&ctx.effects, EFFECT_SPLASH, &(effect_kind_t) {explosion_region, 9, 50, 1, true});
 
-    update_moves_label();
-}
+    create_sprite_from_region(&ctx.turn_arrow, ctx.atlas_texture, &arrow_region);
 
-// Handles soldier selection and attacks
-void handle_click(int tile_x, int tile_y)
-{
-    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
-
-    // Deselect if the player presses the selected soldiers
-    if (tile->soldiers == ctx.selected_soldiers)
-    {
-        clear_selected_soldiers();
+    // The panel has to exist before the first turn starts
+    create_interface();
 
-        return;
-    }
+    // Everything that presents the game has to hear about the changes of the first turn too
+    subscribe_to_events(CHUNK_EVENTS, handle_chunk_event);
+    subscribe_to_events(MINIMAP_EVENTS, handle_minimap_event);
+    subscribe_to_events(ALL_EVENTS, handle_panel_event);
+    subscribe_to_events(EFFECT_EVENTS, handle_effect_event);
 
-    if (!ctx.selected_soldiers)
+    if (map_pack.data)
     {
-        if (tile->soldiers->remaining_moves == 0) return;
-
-        select_soldiers(tile->soldiers, tile_x, tile_y);
+        start_packed_game(&map_pack, map_index);
+        close_map_pack(&map_pack);
     }
-    // Move soldiers
+    else if (scenario_path)
+        start_scenario(scenario_path);
     else
-    {
-        if (ctx.selected_soldiers->current_tile->owner_id != ctx.current_player_id) return;
-
-        // First check if the tile is actually accessible
-        tile_t* source_tile = ctx.selected_soldiers->current_tile;
-        int source_x, source_y;
+        start_game();
 
-        window_to_tile_position(&source_x, &source_y, source_tile->dest_rect.x, source_tile->dest_rect.y);
-        
-        if (!is_neighbouring_tile(source_x, source_y, tile_x, tile_y))
-        {
-            clear_selected_soldiers();
-            
-            return;
-        }
-
-        if (move_soldiers(ctx.selected_soldiers, tile_x, tile_y))
-        {
-            update_stats();
-            decrement_move();
-        }
-        
-        clear_selected_soldiers();
-    }
+    end_phase(&startup, "game state");
+    asset_decoding_ticks = loader.decoding_ticks;
 }
 
-void handle_build(int tile_x, int tile_y, int choice)
+void display_help_and_exit()
 {
-    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
-    if (tile->owner_id != ctx.current_player_id) return;
-    
-    player_t* current_player = &ctx.players[ctx.current_player_id];
-
-    switch (choice)
-    {
-        // Farm creation
-        case 0:
-            if (tile->kind == TILE_GRASS && current_player->coins >= FARM_COST)
-            {
-                current_player->coins -= FARM_COST;
-                current_player->total_farms++;
-
-                set_tile_kind(tile_x, tile_y, TILE_FARM);
-                update_stats();
-                decrement_move();
-            }
+    printf(
+        "Instructions on how to run Hextinction and what arguments it expects:\n"
+        "   ./hextiction [1-4 int, total_players] [optional int, map_seed] [options]\n\n"
+        "   OPTIONS:     --host [port]            waits for the other players to join over the network\n"
+        "                --join [address:port]    joins a hosted game, the host picks the players and the seed\n"
+        "                --spectate [file]        writes the changes of every turn to a file or a named pipe\n"
+        "                --map-pack [file]        loads a pregenerated map instead of generating one (see the seed scanner)\n"
+        "                --map [int]              which map of the pack to play (default 0)\n"
+        "                --scenario [file]        starts from the position of a scenario file, e.g. scenarios/massive_battle.txt\n"
+        "                --startup-report         prints how long every step of the startup took\n"
+        "                --latency-report         prints how long the clicks took to show up on screen (p50, p95, p99) when the game is closed\n"
+        "                --validate               counts every counter of the rules again after each action (slow, for debugging)\n\n"
+        "   NOTES:       if no seed is passed, it will pick one randomly, packed maps have their own seed\n"
+        "                scenarios have their own players and seed and can't be played over the network\n"
+        "                network games use one window per player, e.g. for two players on this machine:\n"
+        "                ./hextinction 2 --host 7777 and ./hextinction --join 127.0.0.1:7777\n"
+    );
 
-            break;
-    }
+    exit(EXIT_FAILURE);
 }
 
-void handle_farm_fix(int tile_x, int tile_y, int choice)
+// The stream can only start once the map exists
+const char* spectator_path = NULL;
+
+void parse_console_arguments(int argc, char** argv)
 {
-    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
-    if (tile->owner_id != ctx.current_player_id) return;
-    
-    player_t* current_player = &ctx.players[ctx.current_player_id];
+    int positional[2];
+    int total_positional = 0;
 
-    if (current_player->coins >= FIX_FARM_COST)
+    int host_port = 0;
+    const char* join_address = NULL;
+    const char* map_pack_path = NULL;
+
+    // Remember that the first argument is the actual file name
+    for (int i = 1; i < argc; i++)
     {
-        current_player->coins -= FIX_FARM_COST;
+        if (strcmp(argv[i], "--host") == 0 && i + 1 < argc)
+            host_port = atoi(argv[++i]);
 
-        set_tile_kind(tile_x, tile_y, TILE_FARM);
-        decrement_move();
-        update_stats();
-    }
-}
+        else if (strcmp(argv[i], "--join") == 0 && i + 1 < argc)
+            join_address = argv[++i];
 
-void handle_train(int tile_x, int tile_y, int choice)
-{
-    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
-    if (tile->owner_id != ctx.current_player_id) return;
-    
-    player_t* current_player = &ctx.players[ctx.current_player_id];
+        else if (strcmp(argv[i], "--spectate") == 0 && i + 1 < argc)
+            spectator_path = argv[++i];
 
-    // Using choice index as enum
-    if (try_to_train_soldiers(tile_x, tile_y, choice))
-    {
-        play_audio(ctx.military_sfx);
-        decrement_move();
-        update_stats();
-    }
-}
+        else if (strcmp(argv[i], "--map-pack") == 0 && i + 1 < argc)
+            map_pack_path = argv[++i];
 
-void initialize_context()
-{
-    // Settings the frame rate to just 20, big performance boost
-    create_game(&ctx.game, "Hextinction", TOTAL_TILEMAP_WIDTH + PANEL_WIDTH, TOTAL_TILEMAP_HEIGHT, 20);
-    ctx.font = TTF_OpenFont("res/free_mono.ttf", 18);
+        else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc)
+            map_index = atoi(argv[++i]);
 
-    // Loading textures and audio
-    ctx.tilemap_texture = load_texture("res/tilemap.png");
-    ctx.border_texture = load_texture("res/border.png");
-    ctx.soldiers_texture = load_texture("res/soldiers.png");
+        else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+            scenario_path = argv[++i];
 
-    ctx.dirt_sfx = load_audio("res/dirt.wav");
-    ctx.cannon_sfx = load_audio("res/cannon.wav");
-    ctx.shipbell_sfx = load_audio("res/shipbell.wav");
-    ctx.military_sfx = load_audio("res/military.wav");
+        else if (strcmp(argv[i], "--startup-report") == 0)
+            show_startup_report = true;
 
-    create_animated_sprite(&ctx.explosion, load_texture("res/explosion.png"), 9, 100);
-    set_transform_scale(&ctx.explosion.sprite.transform, 2);
+        else if (strcmp(argv[i], "--latency-report") == 0)
+            show_latency_report = true;
 
-    ctx.current_player_id = -1; // Will be set to 0 after initial next turn
-    create_sprite(&ctx.turn_arrow, load_texture("res/arrow.png"));
+        else if (strcmp(argv[i], "--validate") == 0)
+            is_validation_enabled = true;
 
-    create_tilemap();
-    generate_unclaimed_cities();
-    create_interface();
-    next_turn();
-}
+        // Negative seeds are fine too
+        else if ((argv[i][0] != '-' || isdigit(argv[i][1])) && total_positional < 2)
+            positional[total_positional++] = atoi(argv[i]);
 
-void display_help_and_exit()
-{
-    printf(
-        "Instructions on how to run Hextinction and what arguments it expects:\n"
-        "   ./hextiction [1-4 int, total_players] [optional int, map_seed]\n\n"
-        "   NOTES:       if no seed is passed, it will pick one randomly\n"
-    );
+        else
+            display_help_and_exit();
+    }
 
-    exit(EXIT_FAILURE);
-}
+    // The host decides everything else
+    if (join_address)
+    {
+        set_map_seed(join_lockstep_game(join_address));
+        return;
+    }
 
-void parse_console_arguments(int argc, char** argv)
-{
-    // Remember that the first argument is the actual file name
-    if (argc < 2)
+    // The other windows would only get the seed, not the position
+    if (scenario_path)
     {
-        display_help_and_exit();
+        if (host_port > 0 || map_pack_path || total_positional > 0)
+            display_help_and_exit();
+
+        return;
     }
 
     // Initializing some context state according to the passed arguments
-    int number_of_players = atoi(argv[1]);
-
-    if (number_of_players < 1 || number_of_players > TOTAL_PLAYERS)
+    if (total_positional < 1 || positional[0] < 1 || positional[0] > TOTAL_PLAYERS)
     {
         display_help_and_exit();
     }
 
-    ctx.starting_players = number_of_players;
-    open_simplex_noise(argc > 2 ? atoi(argv[2]) : rand(), &ctx.noise_context);
+    ctx.starting_players = positional[0];
+    int seed = total_positional > 1 ? positional[1] : rand();
+
+    // Packed maps are still seeded maps, so the other players of a network game can just generate them
+    if (map_pack_path)
+    {
+        open_map_pack(&map_pack, map_pack_path);
+        seed = get_packed_seed(&map_pack, map_index);
+    }
+
+    if (host_port > 0)
+        host_lockstep_game(host_port, ctx.starting_players, seed);
+
+    set_map_seed(seed);
 }
 
 int main(int argc, char** argv)
 {
+    start_phases(&startup);
     srand(time(NULL));
     
     parse_console_arguments(argc, argv);
+    end_phase(&startup, "arguments and network");
+
     initialize_context();
 
+    if (is_validation_enabled)
+        validate_counters("the start of the game");
+
+    if (spectator_path)
+        start_spectator_stream(spectator_path);
+
+    // The checksums of network games need the actions applied right away, see simulation.h
+    if (!ctx.lockstep.is_active)
+        start_simulation();
+
     // Collecting events and defining the game loop
     SDL_Event event;
 
     for (;;)
     {
+        // Actions of network players are applied before any local input
+        poll_lockstep();
+
+        bool has_camera_moved = false;
+
         while (SDL_PollEvent(&event))
         {
             // Closing the game once an exit event has been received
             if (event.type == SDL_QUIT) goto finish_game;
 
+            // Some drivers lose the contents of render targets, the chunks are simply drawn again
+            if (event.type == SDL_RENDER_TARGETS_RESET)
+                mark_all_chunks_outdated();
+
             handle_event(&ctx.game, &event);
 
             if (event.type == SDL_MOUSEBUTTONDOWN)
             {
+                // Dropdowns can reach over the panel, so their clicks count before checking the tile
+                if (event.button.button == SDL_BUTTON_LEFT)
+                {
+                    process_hex_dropdown(&ctx.build_dropdown, handle_build, event.button.timestamp);
+                    process_hex_dropdown(&ctx.train_dropdown, handle_train, event.button.timestamp);
+                    process_hex_dropdown(&ctx.fix_farm_dropdown, handle_farm_fix, event.button.timestamp);
+                }
+
                 // Getting the tile that was clicked
                 int tile_x, tile_y;
                 
                 if (!window_to_tile_position(&tile_x, &tile_y, event.button.x, event.button.y))
-                    break;
+                    continue;
 
                 tile_t* tile = &ctx.tilemap[tile_y][tile_x];
 
                 if (event.button.button == SDL_BUTTON_LEFT)
                 {
-                    process_hex_dropdown(&ctx.build_dropdown, handle_build);
-                    process_hex_dropdown(&ctx.train_dropdown, handle_train);
-                    process_hex_dropdown(&ctx.fix_farm_dropdown, handle_farm_fix);
-
-                    handle_click(tile_x, tile_y);
+                    handle_click(tile_x, tile_y, event.button.timestamp);
                 }
                 // Right click handling
-                else
+                else if (event.button.button == SDL_BUTTON_RIGHT)
                 {
                     if (tile->kind == TILE_CITY)
                         activate_dropdown_at(&ctx.game, &ctx.train_dropdown, event.button.x, event.button.y);
@@ -526,27 +413,11 @@ int main(int argc, char** argv)
 
                     else if (tile->kind == TILE_BROKEN_FARM)
                         activate_dropdown_at(&ctx.game, &ctx.fix_farm_dropdown, event.button.x, event.button.y);
-                }
-            }
 
-            else if (event.type == SDL_MOUSEMOTION)
-            {
-                memset(ctx.is_label_active, 0, TOTAL_LABELS);
+                    else
+                        continue;
 
-                int tile_x, tile_y;
-                
-                // We don't care if the hovered tile does not exist
-                window_to_tile_position(&tile_x, &tile_y, event.motion.x, event.motion.y);
-
-                for (int y = -CITY_PREVIEW_OFFSET_Y; y < CITY_PREVIEW_OFFSET_Y; y++)
-                {
-                    for (int x = -CITY_PREVIEW_OFFSET_X; x < CITY_PREVIEW_OFFSET_X; x++)
-                    {
-                        tile_t* tile = &ctx.tilemap[tile_y + y][tile_x + x];
-
-                        if (is_valid_tile(tile_x + x, tile_y + y) && tile->kind == TILE_CITY)
-                            ctx.is_label_active[tile->label_index] = true;
-                    }
+                    track_input_latency(&ctx.game, event.button.timestamp);
                 }
             }
 
@@ -556,45 +427,93 @@ int main(int argc, char** argv)
                 {
                     // If the space key is pressed, skip turn
                     case SDLK_SPACE:
-                        clear_selected_soldiers();
-                        next_turn();
+                        submit_action(&(action_t) {ACTION_END_TURN, .input_time = event.key.timestamp});
 
                         break;
+
+                    // The arrows scroll the map
+                    case SDLK_LEFT:  move_camera(&ctx.camera, -CAMERA_PAN_STEP, 0); has_camera_moved = true; break;
+                    case SDLK_RIGHT: move_camera(&ctx.camera, CAMERA_PAN_STEP, 0);  has_camera_moved = true; break;
+                    case SDLK_UP:    move_camera(&ctx.camera, 0, -CAMERA_PAN_STEP); has_camera_moved = true; break;
+                    case SDLK_DOWN:  move_camera(&ctx.camera, 0, CAMERA_PAN_STEP);  has_camera_moved = true; break;
                 }
             }
+
+            // Dragging with the middle button scrolls too
+            else if (event.type == SDL_MOUSEMOTION && (event.motion.state & SDL_BUTTON_MMASK))
+            {
+                move_camera(&ctx.camera, -event.motion.xrel, -event.motion.yrel);
+                has_camera_moved = true;
+            }
+
+            // Zooming around the cursor, motion events before this one already updated its position
+            else if (event.type == SDL_MOUSEWHEEL && event.wheel.y != 0)
+            {
+                zoom_camera_at(&ctx.camera, event.wheel.y > 0 ? CAMERA_ZOOM_STEP : 1 / CAMERA_ZOOM_STEP, ctx.game.mouse_x, ctx.game.mouse_y);
+                has_camera_moved = true;
+            }
        }
 
+        // Dropdowns belong to the tile that was under them, which isn't there anymore
+        if (has_camera_moved)
+            ctx.game.active_dropdown = NULL;
+
+        // Hovering only depends on where the cursor ended up, so it's done once per frame
+        if (collect_mouse_motion(&ctx.game) || has_camera_moved)
+        {
+            int tile_x, tile_y;
+
+            // We don't care if the hovered tile does not exist
+            window_to_tile_position(&tile_x, &tile_y, ctx.game.mouse_x, ctx.game.mouse_y);
+            update_hovered_cities(tile_x, tile_y);
+        }
+
+        // Everything that animates uses the same clock, what the events of this frame start begins now
+        ctx.game.frame_time = SDL_GetTicks();
+        update_effects(&ctx.effects, ctx.game.frame_time);
+
+        // Whatever the simulation thread finished by now becomes the state that is drawn
+        sync_simulation();
+
+        // Everything the actions of this frame changed is handed to the caches, the panel and the sounds at once
+        dispatch_events();
+        update_panel();
+
+        // Only does work when a turn has ended
+        update_spectator_stream();
+
+        // Network players only see what they own, on a shared screen it's whoever is playing
+        set_fog_viewer(ctx.lockstep.is_active ? ctx.lockstep.local_player_id : ctx.current_player_id);
+
         SDL_SetRenderDrawColor(ctx.game.renderer, 40, 40, 70, 255);
         SDL_RenderClear(ctx.game.renderer);
 
-        // Rendering the tilemap
-        MAP_FOREACH(x, y)
-        {
-            tile_t* tile = &ctx.tilemap[y][x];
+        // Only the tiles that overlap the view are visited, so bigger maps don't make the frames slower
+        SDL_Rect view = get_camera_view(&ctx.camera);
+        tile_range_t visible = get_tiles_in_rect(&view);
 
-            if (tile->kind != TILE_WATER)
-            {
-                SDL_RenderCopy(ctx.game.renderer, ctx.tilemap_texture, &tile->source_rect, &tile->dest_rect);
+        // Rendering the tilemap, when zoomed out far enough the pre-rendered chunks are much fewer quads
+        int lod_level = get_lod_level(ctx.camera.zoom);
 
-                // Render the border if its conquered on top of the tile
-                if (tile->owner_id >= 0 && tile->kind != TILE_FISH)
-                {
-                    SDL_Color* color = &player_colors[tile->owner_id];
-                    
-                    SDL_SetTextureColorMod(ctx.border_texture, color->r, color->g, color->b);
-                    SDL_SetTextureAlphaMod(ctx.border_texture, color->a);
-                    SDL_RenderCopy(ctx.game.renderer, ctx.border_texture, NULL, &tile->dest_rect);
-                }
-            }
+        if (lod_level > 0)
+        {
+            render_map_chunks(ctx.game.renderer, &ctx.camera, lod_level);
         }
+        else
+        {
+            RANGE_FOREACH(visible, x, y)
+                render_tile(&ctx.tilemap[y][x], ctx.game.renderer, &ctx.camera);
+        }
+
+        reset_atlas_tint();
 
         // Drawing soldiers on top of tiles
-        MAP_FOREACH(x, y)
+        RANGE_FOREACH(visible, x, y)
         {
             tile_t* tile = &ctx.tilemap[y][x];
             
-            if (tile->soldiers)
-                render_soldiers(tile->soldiers, ctx.game.renderer, ctx.soldiers_texture);
+            if (tile->soldiers && is_tile_visible_to_viewer(x, y))
+                render_soldiers(tile->soldiers, ctx.game.renderer, ctx.atlas_texture, ctx.game.frame_time);
         }
 
         // Drawing preview tiles
@@ -604,23 +523,23 @@ int main(int argc, char** argv)
 
             if (tile)
             {
-                SDL_SetTextureColorMod(ctx.border_texture, highlight_color.r, highlight_color.g, highlight_color.b);
-                SDL_SetTextureAlphaMod(ctx.border_texture, highlight_color.a);
-                SDL_RenderCopy(ctx.game.renderer, ctx.border_texture, NULL, &tile->dest_rect);
+                SDL_Rect dest_rect = world_to_screen_rect(&ctx.camera, &tile->dest_rect);
+
+                SDL_SetTextureColorMod(ctx.atlas_texture, highlight_color.r, highlight_color.g, highlight_color.b);
+                SDL_SetTextureAlphaMod(ctx.atlas_texture, highlight_color.a);
+                SDL_RenderCopy(ctx.game.renderer, ctx.atlas_texture, &ctx.border_region, &dest_rect);
             }
         }
 
+        reset_atlas_tint();
+
         // Rendering city labels
-        for (int i = 0; i < TOTAL_LABELS; i++)
-        {
-            if (ctx.is_label_active[i])
-                render_sprite(&ctx.city_labels[i].sprite, ctx.game.renderer);
-        }
+        for (int i = 0; i < ctx.total_active_cities; i++)
+            render_sprite_in_camera(&ctx.camera, &ctx.cities[ctx.active_cities[i]].label.sprite, ctx.game.renderer);
 
-        if (ctx.explosion.is_active)
-            render_animated_sprite(&ctx.explosion, ctx.game.renderer);
+        render_effects(&ctx.effects, ctx.atlas_texture, &ctx.camera, ctx.game.renderer);
 
-        render_sprite(&ctx.turn_arrow, ctx.game.renderer);
+        render_sprite_in_camera(&ctx.camera, &ctx.turn_arrow, ctx.game.renderer);
 
         // Rendering the UI
         SDL_SetRenderDrawColor(ctx.game.renderer, panel_color.r, panel_color.g, panel_color.b, 255);
@@ -634,9 +553,31 @@ int main(int argc, char** argv)
         render_sprite(&ctx.player_income.sprite, ctx.game.renderer);
         render_sprite(&ctx.player_moves.sprite, ctx.game.renderer);
 
+        // Only uploads the tiles that changed since the last frame
+        update_minimap();
+        render_minimap(ctx.game.renderer);
+
         finish_game_rendering(&ctx.game);
+
+        if (show_startup_report && startup.total_phases > 0)
+        {
+            end_phase_at(&startup, "first frame", ctx.game.first_present_time);
+            print_phases(&startup);
+
+            // This happened in the background, mostly during the window creation
+            printf("(decoding the assets took %.2f ms of worker time)\n", asset_decoding_ticks * 1000.0 / SDL_GetPerformanceFrequency());
+
+            show_startup_report = false;
+        }
     }
 
 finish_game:
+    if (show_latency_report)
+        print_latency_histogram(&ctx.game.input_latency, "input to present latency");
+
+    stop_simulation();
+    stop_spectator_stream();
+    destroy_map_chunks();
+    destroy_minimap();
     free_game(&ctx.game);
 }
@@ -0,0 +1,142 @@
+#include <math.h>
+
+#include "map_chunks.h"
+#include "context.h"
+#include "hex_utils.h"
+#include "tile.h"
+
+#define LOD_ALIGNMENT (1 << (TOTAL_LOD_LEVELS - 1))
+
+void mark_chunk_outdated(int tile_x, int tile_y)
+{
+    map_chunk_t* chunk = &ctx.chunks[tile_y / CHUNK_TILES][tile_x / CHUNK_TILES];
+
+    for (int level = 1; level < TOTAL_LOD_LEVELS; level++)
+        chunk->is_outdated[level] = true;
+}
+
+void mark_all_chunks_outdated()
+{
+    for (int y = 0; y < TOTAL_CHUNKS_Y; y++)
+    {
+        for (int x = 0; x < TOTAL_CHUNKS_X; x++)
+            mark_chunk_outdated(x * CHUNK_TILES, y * CHUNK_TILES);
+    }
+}
+
+void handle_chunk_event(const game_event_t* event)
+{
+    if (event)
+        mark_chunk_outdated(event->tile_x, event->tile_y);
+    else
+        mark_all_chunks_outdated();
+}
+
+int get_lod_level(float zoom)
+{
+    if (zoom >= FIRST_LOD_ZOOM)
+        return 0;
+
+    // The closest level that is still at least as detailed as the screen
+    int level = (int) floorf(log2f(1 / zoom));
+
+    return level < TOTAL_LOD_LEVELS ? level : TOTAL_LOD_LEVELS - 1;
+}
+
+static SDL_Rect get_chunk_world_rect(int chunk_x, int chunk_y)
+{
+    int first_x = chunk_x * CHUNK_TILES, first_y = chunk_y * CHUNK_TILES;
+
+    int columns = TILEMAP_WIDTH - first_x < CHUNK_TILES ? TILEMAP_WIDTH - first_x : CHUNK_TILES;
+    int rows = TILEMAP_HEIGHT - first_y < CHUNK_TILES ? TILEMAP_HEIGHT - first_y : CHUNK_TILES;
+
+    // Same formula as assign_tile_position, the odd rows reach further to the right
+    int width = (columns - 1) * HEX_COLUMN_SPACING + HEX_ROW_OFFSET + TILE_WIDTH;
+    int height = (rows - 1) * TILE_HEIGHT / 2 + TILE_HEIGHT;
+
+    return (SDL_Rect) {
+        first_x * HEX_COLUMN_SPACING, first_y * TILE_HEIGHT / 2,
+        (width + LOD_ALIGNMENT - 1) / LOD_ALIGNMENT * LOD_ALIGNMENT, (height + LOD_ALIGNMENT - 1) / LOD_ALIGNMENT * LOD_ALIGNMENT,
+    };
+}
+
+static void render_chunk_texture(SDL_Renderer* renderer, int chunk_x, int chunk_y, int level)
+{
+    map_chunk_t* chunk = &ctx.chunks[chunk_y][chunk_x];
+    chunk->world_rect = get_chunk_world_rect(chunk_x, chunk_y);
+
+    if (!chunk->textures[level])
+    {
+        chunk->textures[level] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+            chunk->world_rect.w >> level, chunk->world_rect.h >> level);
+
+        SDL_SetTextureBlendMode(chunk->textures[level], SDL_BLENDMODE_BLEND);
+    }
+
+    // Drawing the tiles exactly like the map does, but through a camera that fits the chunk in the texture
+    camera_t chunk_camera = {
+        .position = {chunk->world_rect.x, chunk->world_rect.y},
+        .zoom = 1.0f / (1 << level),
+    };
+
+    SDL_SetRenderTarget(renderer, chunk->textures[level]);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    int first_x = chunk_x * CHUNK_TILES, first_y = chunk_y * CHUNK_TILES;
+
+    for (int y = first_y; y < first_y + CHUNK_TILES && y < TILEMAP_HEIGHT; y++)
+    {
+        for (int x = first_x; x < first_x + CHUNK_TILES && x < TILEMAP_WIDTH; x++)
+            render_tile(&ctx.tilemap[y][x], renderer, &chunk_camera);
+    }
+
+    reset_atlas_tint();
+    SDL_SetRenderTarget(renderer, NULL);
+
+    chunk->is_outdated[level] = false;
+}
+
+void render_map_chunks(SDL_Renderer* renderer, const camera_t* camera, int lod_level)
+{
+    SDL_Rect view = get_camera_view(camera);
+    tile_range_t visible = get_tiles_in_rect(&view);
+
+    // The fog outdates the chunks it changes, which has to happen before they are drawn
+    update_fog();
+
+    // An empty range can't be divided into chunks
+    if (visible.first_x > visible.last_x || visible.first_y > visible.last_y)
+        return;
+
+    for (int chunk_y = visible.first_y / CHUNK_TILES; chunk_y <= visible.last_y / CHUNK_TILES; chunk_y++)
+    {
+        for (int chunk_x = visible.first_x / CHUNK_TILES; chunk_x <= visible.last_x / CHUNK_TILES; chunk_x++)
+        {
+            map_chunk_t* chunk = &ctx.chunks[chunk_y][chunk_x];
+
+            if (!chunk->textures[lod_level] || chunk->is_outdated[lod_level])
+                render_chunk_texture(renderer, chunk_x, chunk_y, lod_level);
+
+            SDL_Rect dest_rect = world_to_screen_rect(camera, &chunk->world_rect);
+            SDL_RenderCopy(renderer, chunk->textures[lod_level], NULL, &dest_rect);
+        }
+    }
+}
+
+void destroy_map_chunks()
+{
+    for (int y = 0; y < TOTAL_CHUNKS_Y; y++)
+    {
+        for (int x = 0; x < TOTAL_CHUNKS_X; x++)
+        {
+            for (int level = 1; level < TOTAL_LOD_LEVELS; level++)
+            {
+                if (ctx.chunks[y][x].textures[level])
+                    SDL_DestroyTexture(ctx.chunks[y][x].textures[level]);
+
+                ctx.chunks[y][x].textures[level] = NULL;
+            }
+        }
+    }
+}
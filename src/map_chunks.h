@@ -0,0 +1,49 @@
+#ifndef _MAP_CHUNKS_H
+#define _MAP_CHUNKS_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "engine/camera.h"
+#include "events.h"
+
+/*
+ * When zoomed out, a tile covers only a few pixels, so the map is drawn in squares of CHUNK_TILES x CHUNK_TILES tiles instead
+ * Every chunk is pre-rendered at 1 / 2^level of its size and rendered again only after one of its tiles changes
+ */
+
+#define CHUNK_TILES 16
+#define TOTAL_CHUNKS_X ((TILEMAP_WIDTH + CHUNK_TILES - 1) / CHUNK_TILES)
+#define TOTAL_CHUNKS_Y ((TILEMAP_HEIGHT + CHUNK_TILES - 1) / CHUNK_TILES)
+
+#define TOTAL_LOD_LEVELS 4
+
+// Level 0 is the tiles themselves, it's used until the zoom is below this
+#define FIRST_LOD_ZOOM 0.5f
+
+typedef struct
+{
+    // The part of the world that the tiles of the chunk can cover, the size is a multiple of the smallest level
+    SDL_Rect world_rect;
+
+    // Level 0 is never used, NULL until it's needed
+    SDL_Texture* textures[TOTAL_LOD_LEVELS];
+    bool is_outdated[TOTAL_LOD_LEVELS];
+} map_chunk_t;
+
+// Chunks only draw the tiles, the soldiers are always drawn on top
+#define CHUNK_EVENTS (EVENT_BIT(EVENT_TILE_KIND_CHANGED) | EVENT_BIT(EVENT_TILE_CAPTURED))
+
+// It's only a flag, the chunk is rendered again when it's drawn
+void mark_chunk_outdated(int tile_x, int tile_y);
+void mark_all_chunks_outdated();
+
+void handle_chunk_event(const game_event_t* event);
+
+int get_lod_level(float zoom);
+
+// Renders the outdated chunks of the view before drawing them
+void render_map_chunks(SDL_Renderer* renderer, const camera_t* camera, int lod_level);
+
+void destroy_map_chunks();
+
+#endif
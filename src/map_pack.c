@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "context.h"
+#include "map_pack.h"
+#include "rules.h"
+#include "hex_utils.h"
+#include "engine/utils.h"
+
+// Positions are stored in single bytes
+#if TILEMAP_WIDTH > 255 || TILEMAP_HEIGHT > 255
+#error "Map packs only support maps up to 255x255 tiles"
+#endif
+
+#define KINDS_SIZE ((TILEMAP_WIDTH * TILEMAP_HEIGHT + 1) / 2)
+#define PACKED_MAP_SIZE (8 + KINDS_SIZE + 3 * TOTAL_PLAYERS + 1 + 3 * MAX_PACKED_CITIES)
+
+static uint32_t read_u32(const uint8_t* data)
+{
+    return data[0] | data[1] << 8 | data[2] << 16 | (uint32_t) data[3] << 24;
+}
+
+static void write_u32(uint8_t* data, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        data[i] = value >> (8 * i);
+}
+
+void open_map_pack(map_pack_t* pack, const char* path)
+{
+    int file = open(path, O_RDONLY);
+    assert_panic(file < 0, "Couldn't open the map pack");
+
+    struct stat info;
+    assert_panic(fstat(file, &info) < 0 || info.st_size < MAP_PACK_HEADER_SIZE, "The map pack is empty");
+
+    pack->size = info.st_size;
+    pack->data = mmap(NULL, pack->size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping stays valid after closing the file
+    close(file);
+    assert_panic(pack->data == MAP_FAILED, "Couldn't map the map pack into memory");
+
+    const uint8_t* header = pack->data;
+
+    assert_panic(memcmp(header, MAP_PACK_MAGIC, 4) != 0 || header[4] != MAP_PACK_VERSION, "This isn't a map pack of this version");
+    assert_panic(header[5] != TILEMAP_WIDTH || header[6] != TILEMAP_HEIGHT, "The map pack was made for another map size");
+
+    pack->players = header[7];
+    pack->total_maps = read_u32(header + 8);
+
+    assert_panic(pack->size != MAP_PACK_HEADER_SIZE + (size_t) pack->total_maps * PACKED_MAP_SIZE, "The map pack is corrupted");
+}
+
+void close_map_pack(map_pack_t* pack)
+{
+    munmap((void*) pack->data, pack->size);
+    pack->data = NULL;
+}
+
+static const uint8_t* get_packed_map(const map_pack_t* pack, int map_index)
+{
+    assert_panic(map_index < 0 || map_index >= pack->total_maps, "The map pack doesn't have a map with this index");
+
+    return pack->data + MAP_PACK_HEADER_SIZE + (size_t) map_index * PACKED_MAP_SIZE;
+}
+
+int get_packed_seed(const map_pack_t* pack, int map_index)
+{
+    return (int) read_u32(get_packed_map(pack, map_index));
+}
+
+// The same steps as create_tilemap and generate_unclaimed_cities, but the noise and the random choices are already done
+static void load_packed_map(const uint8_t* map)
+{
+    const uint8_t* kinds = map + 8;
+
+    MAP_FOREACH(x, y)
+    {
+        int index = y * TILEMAP_WIDTH + x;
+        tile_kind_e kind = (kinds[index / 2] >> (index % 2 * 4)) & 0x0f;
+
+        assert_panic(kind >= NUM_TILE_KINDS, "The map pack is corrupted");
+
+        // Cities are created later so that the capitals don't capture them
+        create_tile(x, y, kind == TILE_CITY ? TILE_GRASS : kind);
+    }
+
+    const uint8_t* capitals = kinds + KINDS_SIZE;
+
+    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+    {
+        const uint8_t* capital = capitals + 3 * player_id;
+
+        assert_panic(capital[0] != capital_positions[player_id][0] || capital[1] != capital_positions[player_id][1]
+            || capital[2] >= TOTAL_CITY_NAMES, "The map pack is corrupted");
+
+        place_capital(player_id, capital[2]);
+    }
+
+    const uint8_t* cities = capitals + 3 * TOTAL_PLAYERS;
+    int total_cities = *cities++;
+
+    assert_panic(total_cities > MAX_PACKED_CITIES, "The map pack is corrupted");
+
+    for (int i = 0; i < total_cities; i++)
+    {
+        const uint8_t* city = cities + 3 * i;
+
+        assert_panic(!is_valid_tile(city[0], city[1]) || city[2] >= TOTAL_CITY_NAMES, "The map pack is corrupted");
+        create_city(city[0], city[1], city[2]);
+    }
+
+    ctx.random_state = read_u32(map + 4);
+}
+
+void start_packed_game(const map_pack_t* pack, int map_index)
+{
+    assert_panic(pack->players != ctx.starting_players, "The maps of this pack were made for a different amount of players");
+
+    ctx.current_player_id = -1; // Will be set to 0 after initial next turn
+
+    load_packed_map(get_packed_map(pack, map_index));
+    next_turn();
+}
+
+
+static void pack_current_map(uint8_t* map)
+{
+    write_u32(map, (uint32_t) ctx.map_seed);
+    write_u32(map + 4, ctx.random_state);
+
+    uint8_t* kinds = map + 8;
+
+    MAP_FOREACH(x, y)
+    {
+        int index = y * TILEMAP_WIDTH + x;
+        kinds[index / 2] |= ctx.tilemap[y][x].kind << (index % 2 * 4);
+    }
+
+    uint8_t* capitals = kinds + KINDS_SIZE;
+
+    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+    {
+        int tile_x = capital_positions[player_id][0];
+        int tile_y = capital_positions[player_id][1];
+
+        capitals[3 * player_id] = tile_x;
+        capitals[3 * player_id + 1] = tile_y;
+        capitals[3 * player_id + 2] = ctx.cities[ctx.tilemap[tile_y][tile_x].city_id].name_index;
+    }
+
+    // The registry is in creation order, which is the order of generate_unclaimed_cities
+    uint8_t* packed_cities = capitals + 3 * TOTAL_PLAYERS;
+    int total_cities = 0;
+
+    for (unsigned int city_id = 0; city_id < ctx.total_cities; city_id++)
+    {
+        const city_t* city = &ctx.cities[city_id];
+        if (ctx.tilemap[city->tile_y][city->tile_x].is_capital) continue;
+
+        assert_panic(total_cities == MAX_PACKED_CITIES, "The map has too many cities for a map pack");
+
+        uint8_t* packed_city = packed_cities + 1 + 3 * total_cities++;
+
+        packed_city[0] = city->tile_x;
+        packed_city[1] = city->tile_y;
+        packed_city[2] = city->name_index;
+    }
+
+    *packed_cities = total_cities;
+}
+
+void write_map_pack(const char* path, const int* seeds, int total_seeds, int players)
+{
+    FILE* file = fopen(path, "wb");
+    assert_panic(!file, "Couldn't create the map pack");
+
+    uint8_t header[MAP_PACK_HEADER_SIZE] = {'H', 'X', 'M', 'P', MAP_PACK_VERSION, TILEMAP_WIDTH, TILEMAP_HEIGHT, players};
+    write_u32(header + 8, total_seeds);
+
+    fwrite(header, 1, MAP_PACK_HEADER_SIZE, file);
+
+    for (int i = 0; i < total_seeds; i++)
+    {
+        // Generating the map exactly like a game would
+        memset(&ctx, 0, sizeof(ctx));
+
+        ctx.starting_players = players;
+        ctx.current_player_id = -1;
+        set_map_seed(seeds[i]);
+        create_tilemap();
+        generate_unclaimed_cities();
+
+        uint8_t map[PACKED_MAP_SIZE] = {0};
+        pack_current_map(map);
+
+        fwrite(map, 1, PACKED_MAP_SIZE, file);
+
+        free_game_state();
+    }
+
+    assert_panic(fclose(file) != 0, "Couldn't write the map pack");
+}
@@ -0,0 +1,48 @@
+#ifndef _MAP_PACK_H
+#define _MAP_PACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A map pack is a file with many maps that were already generated (usually the fair seeds of the seed scanner)
+ * The file is memory mapped and a single map is copied into the tilemap, so the noise never has to run
+ *
+ * Layout (numbers are little endian):
+ *   header: "HXMP", version, tilemap width, tilemap height, players, u32 total maps
+ *   map:    i32 seed, u32 random state after the generation, tile kinds (4 bits each, the first tile in the low bits)
+ *           then (x, y, name) of every capital and the amount of neutral cities with their (x, y, name)
+ *
+ * Cities are stored in the order they were created, so the labels and the random state match a generated game
+ */
+
+#define MAP_PACK_MAGIC "HXMP"
+#define MAP_PACK_VERSION 2
+#define MAP_PACK_HEADER_SIZE 12
+
+// generate_unclaimed_cities can't create more than 49 on the default map size
+#define MAX_PACKED_CITIES 64
+
+typedef struct
+{
+    const uint8_t* data;
+    size_t size;
+
+    int players;
+    int total_maps;
+} map_pack_t;
+
+// Panics if the pack can't be read or was made for another map size
+void open_map_pack(map_pack_t* pack, const char* path);
+void close_map_pack(map_pack_t* pack);
+
+// Packed maps are regular seeded maps, so network games just send this seed
+int get_packed_seed(const map_pack_t* pack, int map_index);
+
+// Same as start_game, but the map is copied from the pack, the amount of players must match the pack
+void start_packed_game(const map_pack_t* pack, int map_index);
+
+// Generates the maps of the seeds and writes them to a new pack, this overwrites the context
+void write_map_pack(const char* path, const int* seeds, int total_seeds, int players);
+
+#endif
@@ -0,0 +1,181 @@
+#include "minimap.h"
+#include "context.h"
+#include "hex_utils.h"
+#include "engine/utils.h"
+
+void mark_minimap_tile(int tile_x, int tile_y)
+{
+    if (ctx.minimap.is_outdated)
+        return;
+
+    if (ctx.minimap.total_changes == MINIMAP_MAX_CHANGES)
+    {
+        mark_minimap_outdated();
+        return;
+    }
+
+    ctx.minimap.changed_tiles[ctx.minimap.total_changes++] = tile_y * TILEMAP_WIDTH + tile_x;
+}
+
+void mark_minimap_outdated()
+{
+    ctx.minimap.is_outdated = true;
+    ctx.minimap.total_changes = 0;
+}
+
+void handle_minimap_event(const game_event_t* event)
+{
+    if (!event)
+    {
+        mark_minimap_outdated();
+        return;
+    }
+
+    mark_minimap_tile(event->tile_x, event->tile_y);
+
+    // The stack left the first tile
+    if (event->kind == EVENT_STACK_MOVED)
+        mark_minimap_tile(event->target_x, event->target_y);
+}
+
+static uint32_t get_tile_pixel(int tile_x, int tile_y)
+{
+    const tile_t* tile = &ctx.tilemap[tile_y][tile_x];
+    SDL_Color color = tile_kinds[tile->kind].minimap_color;
+
+    // Same as the map, only the terrain is known under the fog
+    if (!is_tile_visible_to_viewer(tile_x, tile_y))
+    {
+        color.r = color.r * FOG_BRIGHTNESS / 255;
+        color.g = color.g * FOG_BRIGHTNESS / 255;
+        color.b = color.b * FOG_BRIGHTNESS / 255;
+
+        return 0xff000000 | color.r << 16 | color.g << 8 | color.b;
+    }
+
+    // Owned land is tinted with the color of the owner (half way, the colors of the borders are too transparent here)
+    if (tile->owner_id >= 0 && tile_kinds[tile->kind].flags & TILE_SHOWS_OWNER)
+    {
+        SDL_Color* owner = &player_colors[tile->owner_id];
+
+        color.r = (color.r + owner->r) / 2;
+        color.g = (color.g + owner->g) / 2;
+        color.b = (color.b + owner->b) / 2;
+    }
+
+    if (tile->soldiers)
+        color = (SDL_Color) {255, 255, 255, 255};
+
+    return 0xff000000 | color.r << 16 | color.g << 8 | color.b;
+}
+
+void create_minimap(SDL_Renderer* renderer, const SDL_Rect* area)
+{
+    ctx.minimap.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, TILEMAP_WIDTH, TILEMAP_HEIGHT);
+    ctx.minimap.pixels = malloc(TILEMAP_WIDTH * TILEMAP_HEIGHT * sizeof(uint32_t));
+
+    assert_panic(!ctx.minimap.texture || !ctx.minimap.pixels, "Couldn't create the minimap");
+
+    // Keeping the proportions of the map inside the area
+    int width = area->w, height = area->w * TOTAL_TILEMAP_HEIGHT / TOTAL_TILEMAP_WIDTH;
+
+    if (height > area->h)
+    {
+        height = area->h;
+        width = area->h * TOTAL_TILEMAP_WIDTH / TOTAL_TILEMAP_HEIGHT;
+    }
+
+    ctx.minimap.dest_rect = (SDL_Rect) {area->x + (area->w - width) / 2, area->y + (area->h - height) / 2, width, height};
+
+    mark_minimap_outdated();
+}
+
+void update_minimap()
+{
+    minimap_t* minimap = &ctx.minimap;
+    const int pitch = TILEMAP_WIDTH * sizeof(uint32_t);
+
+    // Tiles that appear or disappear from the fog are marked here
+    update_fog();
+
+    if (minimap->is_outdated)
+    {
+        MAP_FOREACH(x, y)
+            minimap->pixels[y * TILEMAP_WIDTH + x] = get_tile_pixel(x, y);
+
+        SDL_UpdateTexture(minimap->texture, NULL, minimap->pixels, pitch);
+
+        minimap->is_outdated = false;
+        minimap->total_changes = 0;
+
+        return;
+    }
+
+    if (minimap->total_changes == 0)
+        return;
+
+    SDL_Rect changed_area = {TILEMAP_WIDTH, TILEMAP_HEIGHT, 0, 0};
+    int right = 0, bottom = 0;
+
+    for (int i = 0; i < minimap->total_changes; i++)
+    {
+        int index = minimap->changed_tiles[i];
+        int x = index % TILEMAP_WIDTH, y = index / TILEMAP_WIDTH;
+
+        minimap->pixels[index] = get_tile_pixel(x, y);
+
+        changed_area.x = MIN(changed_area.x, x);
+        changed_area.y = MIN(changed_area.y, y);
+        right = MAX(right, x + 1);
+        bottom = MAX(bottom, y + 1);
+    }
+
+    // A move changes a few neighbouring tiles, but captures and turns of other players can be all over the map
+    if (minimap->total_changes <= MINIMAP_SINGLE_UPDATES)
+    {
+        for (int i = 0; i < minimap->total_changes; i++)
+        {
+            int index = minimap->changed_tiles[i];
+            SDL_Rect pixel = {index % TILEMAP_WIDTH, index / TILEMAP_WIDTH, 1, 1};
+
+            SDL_UpdateTexture(minimap->texture, &pixel, &minimap->pixels[index], pitch);
+        }
+    }
+    else
+    {
+        changed_area.w = right - changed_area.x;
+        changed_area.h = bottom - changed_area.y;
+
+        SDL_UpdateTexture(minimap->texture, &changed_area, &minimap->pixels[changed_area.y * TILEMAP_WIDTH + changed_area.x], pitch);
+    }
+
+    minimap->total_changes = 0;
+}
+
+void render_minimap(SDL_Renderer* renderer)
+{
+    SDL_RenderCopy(renderer, ctx.minimap.texture, NULL, &ctx.minimap.dest_rect);
+
+    // The part of the map that the camera shows
+    SDL_Rect view = get_camera_view(&ctx.camera);
+    SDL_Rect* dest = &ctx.minimap.dest_rect;
+
+    SDL_Rect outline = {
+        dest->x + view.x * dest->w / TOTAL_TILEMAP_WIDTH, dest->y + view.y * dest->h / TOTAL_TILEMAP_HEIGHT,
+        view.w * dest->w / TOTAL_TILEMAP_WIDTH, view.h * dest->h / TOTAL_TILEMAP_HEIGHT,
+    };
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(renderer, &outline);
+}
+
+void destroy_minimap()
+{
+    if (ctx.minimap.texture)
+        SDL_DestroyTexture(ctx.minimap.texture);
+
+    free(ctx.minimap.pixels);
+
+    ctx.minimap.texture = NULL;
+    ctx.minimap.pixels = NULL;
+}
@@ -0,0 +1,52 @@
+#ifndef _MINIMAP_H
+#define _MINIMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <SDL2/SDL.h>
+#include "events.h"
+
+/*
+ * The whole map in the side panel, one pixel per tile
+ * The pixels live in a streaming texture and only the tiles that changed since the last frame are written again
+ */
+
+// After this many changes in one frame it's cheaper to upload the whole map once
+#define MINIMAP_MAX_CHANGES 1024
+
+// Below this many changes, every tile is uploaded on its own instead of the rectangle around all of them
+#define MINIMAP_SINGLE_UPDATES 64
+
+typedef struct
+{
+    SDL_Texture* texture;
+    SDL_Rect dest_rect;
+
+    // Same pixels as the texture, uploads read from here
+    uint32_t* pixels;
+
+    // Tile indices, the same tile can be in here more than once
+    int changed_tiles[MINIMAP_MAX_CHANGES];
+    int total_changes;
+    bool is_outdated;
+} minimap_t;
+
+// The minimap shows the owners and where the soldiers are
+#define MINIMAP_EVENTS (EVENT_BIT(EVENT_TILE_KIND_CHANGED) | EVENT_BIT(EVENT_TILE_CAPTURED) | EVENT_BIT(EVENT_STACK_CREATED) \
+    | EVENT_BIT(EVENT_STACK_MOVED) | EVENT_BIT(EVENT_STACK_DESTROYED))
+
+// Only remembers the tile, the pixels are written by update_minimap
+void mark_minimap_tile(int tile_x, int tile_y);
+void mark_minimap_outdated();
+
+void handle_minimap_event(const game_event_t* event);
+
+void create_minimap(SDL_Renderer* renderer, const SDL_Rect* area);
+
+// Does nothing if no tile changed since the last call
+void update_minimap();
+void render_minimap(SDL_Renderer* renderer);
+
+void destroy_minimap();
+
+#endif
@@ -0,0 +1,392 @@
+#include <stdio.h>
+
+#include "rules.h"
+#include "context.h"
+#include "hex_utils.h"
+
+// Places grass at the specified position and removes visual glitches
+void place_grass(int tile_x, int tile_y)
+{
+    create_tile(tile_x, tile_y, TILE_GRASS);
+
+    if (is_valid_tile(tile_x, tile_y - 2) && ctx.tilemap[tile_y - 2][tile_x].kind == TILE_COAST)
+    {
+        set_tile_kind(tile_x, tile_y - 2, TILE_GRASS);
+    }
+}
+
+void create_tilemap()
+{
+    // Every tile also looks at the tiles two rows above and below it, so the noise is computed once per position
+    // The rows are shifted by two because the first and last rows look outside of the map
+    double noise[TILEMAP_HEIGHT + 4][TILEMAP_WIDTH];
+
+    for (int y = -2; y < TILEMAP_HEIGHT + 2; y++)
+        for (int x = 0; x < TILEMAP_WIDTH; x++)
+            noise[y + 2][x] = get_noise_value(x, y);
+
+    MAP_FOREACH(x, y)
+    {
+        // Using simplex noise to find out what the tile will be
+        double value = noise[y + 2][x];
+        double bottom = noise[y + 4][x];
+        double top = noise[y][x];
+
+        // All bottom tiles should look like coasts
+        if (value > LAND_START && y > TILEMAP_HEIGHT - 3)
+        {
+            create_tile(x, y, TILE_COAST);
+        }
+        else if (value > LAND_START && bottom < LAND_START)
+        {
+            create_tile(x, y, random_chance(8) ? TILE_PORT : TILE_COAST);
+        }
+        else if (value > LAND_START && top < LAND_START && random_chance(8))
+        {
+            create_tile(x, y, TILE_PORT);
+        }
+        // Forests
+        else if (value > FOREST_START)
+        {
+            create_tile(x, y, TILE_FOREST);
+        }
+        // Threshold for dirt placement
+        else if (value > LAND_START)
+        {
+            create_tile(x, y, random_chance(7) ? TILE_FOREST : TILE_GRASS);
+        }
+        else if (random_chance(10))
+        {
+            create_tile(x, y, TILE_FISH);
+        }
+        else
+        {
+            // Make sure that water tiles have a dest_rect position too
+            assign_tile_position(x, y);
+            set_tile_kind(x, y, TILE_WATER);
+
+            // Otherwise the sea would belong to the first player and ships would take territories from him
+            ctx.tilemap[y][x].owner_id = -1;
+        }
+    }
+
+    // Generating the capitals at the four map edges (if no land is there, it will be generated with a port too)
+    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+        place_capital(player_id, random_city_name());
+}
+
+// Claims the capital of a player and the tiles around it, making sure that he isn't stuck in the sea
+void place_capital(int player_id, int name_index)
+{
+    int tile_x = capital_positions[player_id][0];
+    int tile_y = capital_positions[player_id][1];
+
+    tile_t* capital = &ctx.tilemap[tile_y][tile_x];
+
+    // Making sure that it's a grass tile
+    if (is_water(tile_x, tile_y))
+        place_grass(tile_x, tile_y);
+
+    // The city has to exist before it's captured, otherwise the player doesn't count it
+    create_city(tile_x, tile_y, name_index);
+    capture_tile(tile_x, tile_y, player_id);
+
+    capital->is_capital = true;
+    capital->soldiers = create_soldiers(tile_x, tile_y, SOLDIER_KNIGHT);
+    capital->soldiers->remaining_moves = soldier_kinds[SOLDIER_KNIGHT].moves;
+    
+    ctx.players[player_id].total_units = KNIGHTS_PER_TRAIN;
+    ctx.players[player_id].coins = STARTING_COINS;
+
+    FOREACH_OFFSET(tile_y, TOTAL_NEIGHBOURS, j) 
+    {
+        int x = tile_x + neighbours_offsets[j][0];
+        int y = tile_y + neighbours_offsets[j][1];
+
+        if (!is_valid_tile(x, y)) continue;
+        tile_t* neighbour = &ctx.tilemap[y][x];
+
+        // Make sure that land exists
+        if (is_water(x, y))
+        {
+            place_grass(x, y);
+
+            // Fix some visual glitches
+            if (y > TILEMAP_HEIGHT - 3 || y > tile_y && is_valid_tile(x, y + 2) && is_water(x, y + 2))
+                set_tile_kind(x, y, TILE_COAST);
+        }
+
+        capture_tile(x, y, player_id);
+    }
+
+    // Generating a port at the bottom and at the top tile if the player needs a way to exit his isolated island 
+    // NOTE: The player can still be blocked, but the probability is really low
+    if (is_valid_tile(tile_x, tile_y + 4) && is_water(tile_x, tile_y + 4))
+        set_tile_kind(tile_x, tile_y + 2, TILE_PORT);
+
+    if (is_valid_tile(tile_x, tile_y - 4) && is_water(tile_x, tile_y - 4))
+        set_tile_kind(tile_x, tile_y - 2, TILE_PORT);
+}
+
+// Applies the income of the player whose turn just ended and refreshes his units
+static void finish_player_turn(int player_id)
+{
+    // Applying old player's income
+    player_t* old_player = &ctx.players[player_id];
+    old_player->coins += old_player->income;
+
+    // Checking if the old player is the richest
+    bool was_richest = true;
+
+    for (int i = 0; i < ctx.starting_players; i++)
+    {
+        if (ctx.players[i].income > old_player->income)
+        {
+            was_richest = false;
+            break;
+        }
+    }
+
+    // Resetting soldier moves
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+        if (tile->owner_id != player_id) continue;
+
+        // Make it probable that the richest player's farms get broken, so that the game becomes more balanced
+        if (tile->kind == TILE_FARM && was_richest && old_player->income > 20 && random_chance(15))
+        {
+            set_tile_kind(x, y, TILE_BROKEN_FARM);
+        }
+        else if (tile->kind == TILE_BROKEN_FARM)
+        {
+            old_player->total_farms--;
+            set_tile_kind(x, y, TILE_GRASS);
+        }
+
+        if (tile->soldiers)
+            tile->soldiers->remaining_moves = soldier_kinds[tile->soldiers->kind].moves;
+    }
+}
+
+// The income is shown and used by the bots during the turn, but it only counts when the turn ends
+static void update_income()
+{
+    player_t* player = &ctx.players[ctx.current_player_id];
+    player->income = calculate_income(player);
+}
+
+void next_turn()
+{
+    // The very first call happens before anyone has played
+    if (ctx.current_player_id >= 0)
+        finish_player_turn(ctx.current_player_id);
+
+    // Going to the next player
+    ctx.current_player_id++;
+    ctx.turn++;
+    ctx.selected_soldiers = NULL;
+    ctx.remaining_moves = MOVES_PER_TURN;
+
+    if (ctx.current_player_id > ctx.starting_players - 1)
+        ctx.current_player_id = 0;
+
+    // Skip if the player is dead
+    if (ctx.players[ctx.current_player_id].is_dead) return next_turn();
+
+    // Check if the player is bankrupt
+    if (ctx.players[ctx.current_player_id].coins < 0)
+    {
+        ctx.players[ctx.current_player_id].coins = 0;
+
+        MAP_FOREACH(x, y)
+        {
+            tile_t* tile = &ctx.tilemap[y][x];
+
+            if (tile->owner_id == ctx.current_player_id && tile->soldiers != NULL)
+            {
+                // The upkeep has to go away with the army, otherwise the player stays bankrupt forever
+                if (soldier_kinds[tile->soldiers->kind].flags & SOLDIER_HAS_UNITS)
+                    ctx.players[ctx.current_player_id].total_units -= tile->soldiers->units;
+
+                destroy_soldiers(tile->soldiers);
+            }
+        }
+    }
+
+    update_income();
+    publish_event((game_event_t) {EVENT_TURN_ENDED, .player_id = ctx.current_player_id});
+}
+
+void generate_unclaimed_cities()
+{
+    int current_x = 0;
+    int current_y = 0;
+
+    while (current_y < TILEMAP_HEIGHT - 3)
+    {
+        int offset_x = random_range(2);
+        int offset_y = random_range(3);
+
+        tile_t* tile = &ctx.tilemap[current_y + offset_y][current_x + offset_x];
+
+        // Spawn only in empty grass/forest tiles
+        if (tile->owner_id < 0 && (tile->kind == TILE_GRASS || tile->kind == TILE_FOREST))
+        {
+            create_city(current_x + offset_x, current_y + offset_y, random_city_name());
+        }
+
+        // This algorithm moves in "chunks" and just determines some offset for a more organic result
+        current_x += 3;
+
+        if (current_x > TILEMAP_WIDTH - 2)
+        {
+            current_x = 0;
+            current_y += 5;
+        }
+    }
+}
+
+int calculate_income(player_t* player)
+{
+    return tile_kinds[TILE_FARM].income * player->total_farms + tile_kinds[TILE_CITY].income * player->total_cities
+        - (player->total_units / 10) * COST_PER_10_UNITS + player->total_territories / TERRITORIES_PER_COIN;
+}
+
+int find_winner()
+{
+    int winner = -1;
+
+    for (int i = 0; i < ctx.starting_players; i++)
+    {
+        if (ctx.players[i].is_dead) continue;
+
+        // More than one player is still alive
+        if (winner >= 0) return -1;
+
+        winner = i;
+    }
+
+    return winner;
+}
+
+void start_game()
+{
+    ctx.current_player_id = -1; // Will be set to 0 after initial next turn
+
+    create_tilemap();
+    generate_unclaimed_cities();
+    next_turn();
+}
+
+void free_game_state()
+{
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+
+        if (tile->soldiers)
+            destroy_soldiers(tile->soldiers);
+    }
+
+    for (unsigned int i = 0; i < ctx.total_cities; i++)
+        destroy_label(&ctx.cities[i].label);
+
+    ctx.total_cities = 0;
+    memset(ctx.first_owned_city, 0, sizeof(ctx.first_owned_city));
+    memset(ctx.name_uses, 0, sizeof(ctx.name_uses));
+    memset(ctx.city_grid, 0, sizeof(ctx.city_grid));
+    ctx.total_active_cities = 0;
+
+    // The next game may reuse the context without going through its tiles
+    mark_fog_outdated();
+
+    // next_turn fills the panel even when there is no window
+    destroy_label(&ctx.player_name);
+    destroy_label(&ctx.player_description);
+    destroy_label(&ctx.player_coins);
+    destroy_label(&ctx.player_territories);
+    destroy_label(&ctx.player_income);
+    destroy_label(&ctx.player_moves);
+
+    open_simplex_noise_free(ctx.noise_context);
+    ctx.noise_context = NULL;
+}
+
+void decrement_move()
+{
+    ctx.remaining_moves--;
+
+    // Check if the turn has ended
+    if (ctx.remaining_moves == 0)
+        next_turn();
+}
+
+// The functions below are the only ways a player can change the game, they are called by apply_action
+bool move_soldiers_between(int source_x, int source_y, int tile_x, int tile_y)
+{
+    soldiers_t* soldiers = ctx.tilemap[source_y][source_x].soldiers;
+
+    if (!soldiers || soldiers->current_tile->owner_id != ctx.current_player_id) return false;
+
+    // First check if the tile is actually accessible
+    if (!is_neighbouring_tile(source_x, source_y, tile_x, tile_y)) return false;
+
+    if (!move_soldiers(soldiers, tile_x, tile_y)) return false;
+
+    update_income();
+    decrement_move();
+
+    return true;
+}
+
+bool build_farm(int tile_x, int tile_y)
+{
+    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
+    if (tile->owner_id != ctx.current_player_id) return false;
+    
+    player_t* current_player = &ctx.players[ctx.current_player_id];
+
+    if (tile->kind != TILE_GRASS || current_player->coins < FARM_COST) return false;
+
+    current_player->coins -= FARM_COST;
+    current_player->total_farms++;
+
+    set_tile_kind(tile_x, tile_y, TILE_FARM);
+    update_income();
+    decrement_move();
+
+    return true;
+}
+
+bool fix_farm(int tile_x, int tile_y)
+{
+    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
+    if (tile->owner_id != ctx.current_player_id) return false;
+    
+    player_t* current_player = &ctx.players[ctx.current_player_id];
+
+    if (tile->kind != TILE_BROKEN_FARM || current_player->coins < FIX_FARM_COST) return false;
+
+    current_player->coins -= FIX_FARM_COST;
+
+    set_tile_kind(tile_x, tile_y, TILE_FARM);
+    update_income();
+    decrement_move();
+
+    return true;
+}
+
+bool train_soldiers(int tile_x, int tile_y, soldier_kind_e kind)
+{
+    tile_t* tile = &ctx.tilemap[tile_y][tile_x];
+    if (tile->owner_id != ctx.current_player_id || !(tile_kinds[tile->kind].flags & TILE_IS_CITY)) return false;
+
+    if (!try_to_train_soldiers(tile_x, tile_y, kind)) return false;
+
+    publish_event((game_event_t) {EVENT_SOLDIERS_TRAINED, tile_x, tile_y, .player_id = ctx.current_player_id, .value = kind});
+    update_income();
+    decrement_move();
+
+    return true;
+}
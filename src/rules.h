@@ -0,0 +1,37 @@
+#ifndef _RULES_H
+#define _RULES_H
+
+#include <stdbool.h>
+#include "context.h"
+#include "soldiers.h"
+
+/*
+ * The game rules that don't belong to a single tile or soldier
+ * Everything here must only depend on the context so that every copy of the game reaches the same state
+ */
+
+void create_tilemap();
+void place_capital(int player_id, int name_index);
+void generate_unclaimed_cities();
+
+// Creates the map and starts the first turn, the seed and the amount of players must be set before
+void start_game();
+
+// Frees everything that start_game allocated, used by the tools that play many games
+void free_game_state();
+
+void next_turn();
+void decrement_move();
+
+int calculate_income(player_t* player);
+
+// Returns -1 while more than one player is alive
+int find_winner();
+
+// Player actions, they validate their input and return false if nothing happened
+bool move_soldiers_between(int source_x, int source_y, int tile_x, int tile_y);
+bool build_farm(int tile_x, int tile_y);
+bool fix_farm(int tile_x, int tile_y);
+bool train_soldiers(int tile_x, int tile_y, soldier_kind_e kind);
+
+#endif
@@ -0,0 +1,146 @@
+#include "savestate.h"
+
+void save_state(savestate_t* state)
+{
+    memcpy(state->tilemap, ctx.tilemap, sizeof(ctx.tilemap));
+    memcpy(state->players, ctx.players, sizeof(ctx.players));
+
+    state->current_player_id = ctx.current_player_id;
+    state->remaining_moves = ctx.remaining_moves;
+    state->turn = ctx.turn;
+    state->total_cities = ctx.total_cities;
+    state->random_state = ctx.random_state;
+
+    state->total_stacks = 0;
+
+    MAP_FOREACH(x, y)
+    {
+        soldiers_t* soldiers = ctx.tilemap[y][x].soldiers;
+        if (!soldiers) continue;
+
+        state->stacks[state->total_stacks++] = (stack_state_t) {
+            y * TILEMAP_WIDTH + x, soldiers->kind, soldiers->units, soldiers->remaining_moves,
+        };
+    }
+}
+
+void load_state(const savestate_t* state)
+{
+    // The current soldiers are replaced by new ones
+    MAP_FOREACH(x, y)
+    {
+        if (ctx.tilemap[y][x].soldiers)
+            destroy_soldiers(ctx.tilemap[y][x].soldiers);
+    }
+
+    // The search bot loads after every move it tries, so the fog only looks again at the tiles that change owner
+    // The soldiers were already marked when they were destroyed above and are marked again when they are created below
+    MAP_FOREACH(x, y)
+    {
+        if (ctx.tilemap[y][x].owner_id != state->tilemap[y][x].owner_id)
+            mark_fog_tile(x, y);
+    }
+
+    memcpy(ctx.tilemap, state->tilemap, sizeof(ctx.tilemap));
+    publish_reset_event();
+
+    // The state might come from another context (like the one of the simulation thread), which has no cities yet
+    index_cities();
+    memcpy(ctx.players, state->players, sizeof(ctx.players));
+
+    ctx.current_player_id = state->current_player_id;
+    ctx.remaining_moves = state->remaining_moves;
+    ctx.turn = state->turn;
+    ctx.total_cities = state->total_cities;
+    ctx.random_state = state->random_state;
+
+    ctx.selected_soldiers = NULL;
+
+    MAP_FOREACH(x, y)
+        ctx.tilemap[y][x].soldiers = NULL;
+
+    for (int i = 0; i < state->total_stacks; i++)
+    {
+        const stack_state_t* stack = &state->stacks[i];
+        int tile_x = stack->tile_index % TILEMAP_WIDTH;
+        int tile_y = stack->tile_index / TILEMAP_WIDTH;
+
+        soldiers_t* soldiers = create_soldiers(tile_x, tile_y, stack->kind);
+
+        if (soldier_kinds[stack->kind].flags & SOLDIER_HAS_UNITS)
+            set_soldier_units(soldiers, stack->units);
+        else
+            update_soldiers_texture(soldiers);
+
+        soldiers->remaining_moves = stack->remaining_moves;
+    }
+}
+
+void sync_to_state(const savestate_t* state)
+{
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+        const tile_t* new_tile = &state->tilemap[y][x];
+
+        if (tile->kind != new_tile->kind)
+            set_tile_kind(x, y, new_tile->kind);
+
+        if (tile->owner_id != new_tile->owner_id)
+        {
+            int previous_owner = tile->owner_id;
+            tile->owner_id = new_tile->owner_id;
+
+            if (tile_kinds[tile->kind].flags & TILE_IS_CITY)
+                set_city_owner(tile->city_id, previous_owner, tile->owner_id);
+
+            publish_event((game_event_t) {EVENT_TILE_CAPTURED, x, y, .player_id = new_tile->owner_id, .value = previous_owner});
+        }
+
+        tile->is_capital = new_tile->is_capital;
+    }
+
+    // The stacks are stored in the order of MAP_FOREACH, so they are walked along with the tiles
+    int stack_index = 0;
+
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+        const stack_state_t* stack = NULL;
+
+        if (stack_index < state->total_stacks && state->stacks[stack_index].tile_index == y * TILEMAP_WIDTH + x)
+            stack = &state->stacks[stack_index++];
+
+        // A stack of another kind is another stack, like a saboteur that was beaten
+        if (tile->soldiers && (!stack || tile->soldiers->kind != stack->kind))
+        {
+            if (tile->soldiers == ctx.selected_soldiers)
+                clear_selected_soldiers();
+
+            destroy_soldiers(tile->soldiers);
+        }
+
+        if (!stack) continue;
+
+        soldiers_t* soldiers = tile->soldiers ? tile->soldiers : create_soldiers(x, y, stack->kind);
+
+        if ((soldier_kinds[stack->kind].flags & SOLDIER_HAS_UNITS) && soldiers->units != stack->units)
+            set_soldier_units(soldiers, stack->units);
+
+        // Ships take the color of the owner
+        update_soldiers_texture(soldiers);
+        soldiers->remaining_moves = stack->remaining_moves;
+    }
+
+    // The selection belongs to the player whose turn it was
+    if (ctx.turn != state->turn || ctx.current_player_id != state->current_player_id)
+        clear_selected_soldiers();
+
+    memcpy(ctx.players, state->players, sizeof(ctx.players));
+
+    ctx.current_player_id = state->current_player_id;
+    ctx.remaining_moves = state->remaining_moves;
+    ctx.turn = state->turn;
+    ctx.total_cities = state->total_cities;
+    ctx.random_state = state->random_state;
+}
@@ -0,0 +1,43 @@
+#ifndef _SAVESTATE_H
+#define _SAVESTATE_H
+
+#include "context.h"
+
+/*
+ * A copy of everything the rules can change, used to try out actions and undo them afterwards
+ * Soldiers are stored by value because the pointers of the tiles can't survive a restore
+ */
+
+typedef struct
+{
+    int tile_index;
+
+    soldier_kind_e kind;
+    unsigned int units;
+    unsigned int remaining_moves;
+} stack_state_t;
+
+typedef struct
+{
+    tile_t tilemap[TILEMAP_HEIGHT][TILEMAP_WIDTH];
+
+    stack_state_t stacks[TILEMAP_WIDTH * TILEMAP_HEIGHT];
+    int total_stacks;
+
+    player_t players[TOTAL_PLAYERS];
+    int current_player_id;
+    int remaining_moves;
+    unsigned int turn;
+    unsigned int total_cities;
+    uint32_t random_state;
+} savestate_t;
+
+// It's big, so it should be malloced
+void save_state(savestate_t* state);
+void load_state(const savestate_t* state);
+
+// Like load_state, but only what differs is changed and published as events, so the caches don't have to start over
+// The soldiers of the state are only looked at by value, it can come from another context (see simulation.h)
+void sync_to_state(const savestate_t* state);
+
+#endif
@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include "scenario.h"
+#include "context.h"
+#include "rules.h"
+#include "hex_utils.h"
+#include "engine/utils.h"
+
+#define SCENARIO_LINE_LENGTH 256
+
+typedef struct
+{
+    int tile_x, tile_y;
+    soldier_kind_e kind;
+    int units;
+    int moves;
+} scenario_stack_t;
+
+// Everything is read before the map is touched, so a broken file doesn't leave half a game behind
+typedef struct
+{
+    int players;
+    int seed;
+    int turn;
+    int current_player_id;
+    int remaining_moves;
+
+    int coins[TOTAL_PLAYERS];
+    bool is_dead[TOTAL_PLAYERS];
+
+    bool has_terrain, has_owners;
+    tile_kind_e terrain[TILEMAP_HEIGHT][TILEMAP_WIDTH];
+    int owners[TILEMAP_HEIGHT][TILEMAP_WIDTH];
+
+    // -1 picks a random name
+    int names[TILEMAP_HEIGHT][TILEMAP_WIDTH];
+
+    scenario_stack_t stacks[TILEMAP_WIDTH * TILEMAP_HEIGHT];
+    int total_stacks;
+} scenario_t;
+
+typedef struct
+{
+    FILE* file;
+    const char* path;
+    int line_number;
+    char line[SCENARIO_LINE_LENGTH];
+} scenario_reader_t;
+
+static const char* soldier_names[NUM_SOLDIERS] = {
+#define SOLDIER_KIND(name, ...) [SOLDIER_##name] = #name,
+#include "soldier_kinds.def"
+#undef SOLDIER_KIND
+};
+
+static void check_scenario(const scenario_reader_t* reader, bool condition, const char* message)
+{
+    // Errors found while placing the scenario don't have a single line to blame
+    if (condition && reader->line_number > 0)
+        printf("%s:%d: ", reader->path, reader->line_number);
+    else if (condition)
+        printf("%s: ", reader->path);
+
+    assert_panic(condition, message);
+}
+
+// Skips the empty lines and the comments, returns false at the end of the file
+static bool read_statement(scenario_reader_t* reader)
+{
+    while (fgets(reader->line, SCENARIO_LINE_LENGTH, reader->file))
+    {
+        reader->line_number++;
+        reader->line[strcspn(reader->line, "\r\n")] = '\0';
+
+        const char* start = reader->line + strspn(reader->line, " \t");
+
+        if (*start != '\0' && *start != '#')
+            return true;
+    }
+
+    return false;
+}
+
+// Reads the next row of a grid without its spaces, returns its length
+static int read_row(scenario_reader_t* reader, char* row)
+{
+    check_scenario(reader, !read_statement(reader), "The file ends in the middle of a grid");
+
+    int length = 0;
+
+    for (const char* c = reader->line; *c; c++)
+    {
+        if (*c != ' ' && *c != '\t')
+            row[length++] = *c;
+    }
+
+    return length;
+}
+
+static void read_terrain(scenario_reader_t* reader, scenario_t* scenario)
+{
+    for (int y = 0; y < TILEMAP_HEIGHT; y++)
+    {
+        char row[SCENARIO_LINE_LENGTH];
+        check_scenario(reader, read_row(reader, row) != TILEMAP_WIDTH, "Every terrain row needs a symbol for every tile");
+
+        for (int x = 0; x < TILEMAP_WIDTH; x++)
+        {
+            int kind = 0;
+
+            while (kind < NUM_TILE_KINDS && tile_kinds[kind].symbol != row[x])
+                kind++;
+
+            check_scenario(reader, kind == NUM_TILE_KINDS, "Unknown terrain symbol");
+            scenario->terrain[y][x] = kind;
+        }
+    }
+
+    scenario->has_terrain = true;
+}
+
+static void read_owners(scenario_reader_t* reader, scenario_t* scenario)
+{
+    for (int y = 0; y < TILEMAP_HEIGHT; y++)
+    {
+        char row[SCENARIO_LINE_LENGTH];
+        check_scenario(reader, read_row(reader, row) != TILEMAP_WIDTH, "Every owners row needs a symbol for every tile");
+
+        for (int x = 0; x < TILEMAP_WIDTH; x++)
+        {
+            check_scenario(reader, row[x] != '-' && (row[x] < '0' || row[x] >= '0' + TOTAL_PLAYERS), "Owners are - or a player");
+            scenario->owners[y][x] = row[x] == '-' ? -1 : row[x] - '0';
+        }
+    }
+
+    scenario->has_owners = true;
+}
+
+static void read_stack(scenario_reader_t* reader, scenario_t* scenario)
+{
+    scenario_stack_t* stack = &scenario->stacks[scenario->total_stacks];
+    char kind_name[32];
+
+    check_scenario(reader, sscanf(reader->line, "stack %d %d %31s %d %d", &stack->tile_x, &stack->tile_y, kind_name,
+        &stack->units, &stack->moves) != 5, "Stacks need a position, a kind, units and moves");
+
+    check_scenario(reader, !is_valid_tile(stack->tile_x, stack->tile_y), "The stack is outside of the map");
+
+    int kind = 0;
+
+    while (kind < NUM_SOLDIERS && strcasecmp(soldier_names[kind], kind_name) != 0)
+        kind++;
+
+    check_scenario(reader, kind == NUM_SOLDIERS, "Unknown soldier kind");
+    stack->kind = kind;
+
+    check_scenario(reader, soldier_kinds[kind].flags & SOLDIER_HAS_UNITS && (stack->units < 1 || stack->units > MAX_UNITS),
+        "The units of a stack must be between 1 and MAX_UNITS");
+    check_scenario(reader, stack->moves < 0 || stack->moves > soldier_kinds[kind].moves, "The stack has more moves than its kind");
+
+    // There can't be more stacks than tiles, placing them checks for duplicates
+    check_scenario(reader, scenario->total_stacks == TILEMAP_WIDTH * TILEMAP_HEIGHT, "Too many stacks");
+    scenario->total_stacks++;
+}
+
+static void read_city_name(scenario_reader_t* reader, scenario_t* scenario)
+{
+    int tile_x, tile_y, name_start;
+
+    check_scenario(reader, sscanf(reader->line, "city %d %d %n", &tile_x, &tile_y, &name_start) != 2
+        || reader->line[name_start] == '\0', "Cities need a position and a name");
+    check_scenario(reader, !is_valid_tile(tile_x, tile_y), "The city is outside of the map");
+
+    int name_index = 0;
+
+    while (name_index < TOTAL_CITY_NAMES && strcmp(city_names[name_index], reader->line + name_start) != 0)
+        name_index++;
+
+    check_scenario(reader, name_index == TOTAL_CITY_NAMES, "Unknown city name");
+    scenario->names[tile_y][tile_x] = name_index;
+}
+
+static bool is_player(const scenario_t* scenario, int player_id)
+{
+    return player_id >= 0 && player_id < scenario->players;
+}
+
+static void read_scenario(scenario_reader_t* reader, scenario_t* scenario)
+{
+    int version;
+
+    check_scenario(reader, !read_statement(reader) || sscanf(reader->line, "hextinction-scenario %d", &version) != 1,
+        "This isn't a scenario file");
+    check_scenario(reader, version != SCENARIO_VERSION, "The scenario was made for another version");
+
+    while (read_statement(reader))
+    {
+        char keyword[32];
+        int first, second;
+
+        sscanf(reader->line, "%31s", keyword);
+
+        if (strcmp(keyword, "size") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "size %d %d", &first, &second) != 2, "The size needs a width and a height");
+            check_scenario(reader, first != TILEMAP_WIDTH || second != TILEMAP_HEIGHT, "The scenario was made for another map size");
+        }
+        else if (strcmp(keyword, "players") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "players %d", &scenario->players) != 1
+                || scenario->players < 1 || scenario->players > TOTAL_PLAYERS, "The players must be between 1 and TOTAL_PLAYERS");
+        }
+        else if (strcmp(keyword, "seed") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "seed %d", &scenario->seed) != 1, "The seed needs a number");
+        }
+        else if (strcmp(keyword, "turn") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "turn %d", &scenario->turn) != 1 || scenario->turn < 1, "The turn must be positive");
+        }
+        else if (strcmp(keyword, "current") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "current %d", &scenario->current_player_id) != 1, "Current needs a player");
+        }
+        else if (strcmp(keyword, "moves") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "moves %d", &scenario->remaining_moves) != 1
+                || scenario->remaining_moves < 1 || scenario->remaining_moves > MOVES_PER_TURN, "The moves must be between 1 and MOVES_PER_TURN");
+        }
+        else if (strcmp(keyword, "coins") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "coins %d %d", &first, &second) != 2 || !is_player(scenario, first),
+                "Coins need a player and an amount, after the players statement");
+            scenario->coins[first] = second;
+        }
+        else if (strcmp(keyword, "dead") == 0)
+        {
+            check_scenario(reader, sscanf(reader->line, "dead %d", &first) != 1 || !is_player(scenario, first),
+                "Dead needs a player, after the players statement");
+            scenario->is_dead[first] = true;
+        }
+        else if (strcmp(keyword, "terrain") == 0)
+            read_terrain(reader, scenario);
+
+        else if (strcmp(keyword, "owners") == 0)
+            read_owners(reader, scenario);
+
+        else if (strcmp(keyword, "stack") == 0)
+            read_stack(reader, scenario);
+
+        else if (strcmp(keyword, "city") == 0)
+            read_city_name(reader, scenario);
+
+        else
+            check_scenario(reader, true, "Unknown statement");
+    }
+
+    check_scenario(reader, scenario->players == 0 || !scenario->has_terrain || !scenario->has_owners,
+        "Scenarios need at least the players, the terrain and the owners");
+    check_scenario(reader, !is_player(scenario, scenario->current_player_id) || scenario->is_dead[scenario->current_player_id],
+        "The current player must be alive");
+}
+
+static void place_scenario(const scenario_reader_t* reader, const scenario_t* scenario)
+{
+    ctx.starting_players = scenario->players;
+    set_map_seed(scenario->seed);
+
+    // Farms are planted after the tiles are captured because capturing them counts them, like build_farm does
+    MAP_FOREACH(x, y)
+    {
+        tile_kind_e kind = scenario->terrain[y][x];
+        create_tile(x, y, tile_kinds[kind].flags & TILE_IS_FARM ? TILE_GRASS : kind);
+
+        if (kind == TILE_CITY)
+        {
+            int name_index = scenario->names[y][x];
+            create_city(x, y, name_index >= 0 ? name_index : random_city_name());
+        }
+        else
+            check_scenario(reader, scenario->names[y][x] >= 0, "A city name was given to a tile that isn't a city");
+    }
+
+    MAP_FOREACH(x, y)
+    {
+        int owner_id = scenario->owners[y][x];
+        tile_kind_e kind = scenario->terrain[y][x];
+
+        if (owner_id < 0)
+        {
+            check_scenario(reader, tile_kinds[kind].flags & TILE_IS_FARM, "Farms must be owned");
+            continue;
+        }
+
+        check_scenario(reader, !is_player(scenario, owner_id) || scenario->is_dead[owner_id], "A tile is owned by a missing or dead player");
+        check_scenario(reader, kind == TILE_FISH, "Fish can't be owned, capturing them collects them");
+
+        capture_tile(x, y, owner_id);
+
+        if (tile_kinds[kind].flags & TILE_IS_FARM)
+        {
+            set_tile_kind(x, y, kind);
+            ctx.players[owner_id].total_farms++;
+        }
+    }
+
+    for (int player_id = 0; player_id < scenario->players; player_id++)
+    {
+        player_t* player = &ctx.players[player_id];
+
+        player->is_dead = scenario->is_dead[player_id];
+        player->coins = scenario->coins[player_id];
+
+        if (player->is_dead) continue;
+
+        tile_t* capital = &ctx.tilemap[capital_positions[player_id][1]][capital_positions[player_id][0]];
+
+        check_scenario(reader, capital->kind != TILE_CITY || capital->owner_id != player_id,
+            "Every living player needs a city of his own at his capital position");
+        capital->is_capital = true;
+    }
+
+    for (int i = 0; i < scenario->total_stacks; i++)
+    {
+        const scenario_stack_t* stack = &scenario->stacks[i];
+        tile_t* tile = &ctx.tilemap[stack->tile_y][stack->tile_x];
+
+        check_scenario(reader, tile->owner_id < 0, "Stacks belong to the owner of their tile, so it can't be neutral");
+        check_scenario(reader, tile->soldiers != NULL, "There are two stacks on the same tile");
+
+        soldiers_t* soldiers = create_soldiers(stack->tile_x, stack->tile_y, stack->kind);
+        soldiers->remaining_moves = stack->moves;
+
+        if (soldier_kinds[stack->kind].flags & SOLDIER_HAS_UNITS)
+        {
+            set_soldier_units(soldiers, stack->units);
+            ctx.players[tile->owner_id].total_units += stack->units;
+        }
+    }
+
+    ctx.current_player_id = scenario->current_player_id;
+    ctx.remaining_moves = scenario->remaining_moves;
+    ctx.turn = scenario->turn;
+    ctx.selected_soldiers = NULL;
+
+    // next_turn only calculates the income of the current player, the others would have theirs from their last turn
+    for (int player_id = 0; player_id < scenario->players; player_id++)
+        ctx.players[player_id].income = calculate_income(&ctx.players[player_id]);
+
+    publish_event((game_event_t) {EVENT_TURN_ENDED, .player_id = ctx.current_player_id});
+}
+
+void start_scenario(const char* path)
+{
+    scenario_reader_t reader = {fopen(path, "r"), path};
+    assert_panic(!reader.file, "Couldn't open the scenario");
+
+    scenario_t scenario = {.turn = 1, .remaining_moves = MOVES_PER_TURN};
+
+    for (int i = 0; i < TOTAL_PLAYERS; i++)
+        scenario.coins[i] = STARTING_COINS;
+
+    MAP_FOREACH(x, y)
+        scenario.names[y][x] = -1;
+
+    read_scenario(&reader, &scenario);
+    fclose(reader.file);
+
+    reader.line_number = 0;
+    place_scenario(&reader, &scenario);
+}
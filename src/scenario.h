@@ -0,0 +1,33 @@
+#ifndef _SCENARIO_H
+#define _SCENARIO_H
+
+/*
+ * A scenario is a text file with an exact position, so benchmarks and tests can start from the same situation every time
+ * Everything is placed through the regular rules (create_tile, capture_tile, create_soldiers) so the counters stay right
+ *
+ * Format, one statement per line, empty lines and lines starting with # are ignored:
+ *   hextinction-scenario 1           must be the first statement
+ *   size [width] [height]            must match TILEMAP_WIDTH and TILEMAP_HEIGHT
+ *   players [1-4]
+ *   seed [int]                       for the randomness of the rest of the game (default 0)
+ *   turn [int]                       (default 1)
+ *   current [player]                 whose turn it is (default 0)
+ *   moves [int]                      moves left in the current turn (default MOVES_PER_TURN)
+ *   coins [player] [int]             can be negative, the player goes bankrupt when his turn starts (default STARTING_COINS)
+ *   dead [player]                    dead players can't own anything
+ *   terrain                          followed by a row of symbols for every row of the map (see tile_kinds.def)
+ *   owners                           followed by a row for every row of the map, a digit is the owner and - is neutral
+ *   stack [x] [y] [kind] [units] [moves]   the units are ignored by kinds without units (see soldier_kinds.def)
+ *   city [x] [y] [name]              one of city_names, the other cities get a random one
+ *
+ * Spaces inside of the rows are ignored, so the odd rows can be indented to look like the hex grid
+ * Every living player needs a city at his capital position, which becomes his capital
+ */
+
+#define SCENARIO_VERSION 1
+
+// Replaces start_game, the amount of players and the seed come from the file too
+// Panics with the line number if something is wrong
+void start_scenario(const char* path);
+
+#endif
@@ -0,0 +1,237 @@
+#include <stdatomic.h>
+#include <SDL2/SDL.h>
+
+#include "simulation.h"
+#include "context.h"
+#include "rules.h"
+#include "savestate.h"
+#include "engine/spsc_queue.h"
+#include "engine/triple_buffer.h"
+#include "engine/utils.h"
+
+// What the main thread gets after every batch of actions
+typedef struct
+{
+    savestate_t state;
+
+    // Everything the main thread hasn't confirmed yet, the events start at number first_event
+    // A skipped frame is simply replaced, the next one still has its events so nothing arrives late or out of order
+    game_event_t events[MAX_FRAME_EVENTS];
+    unsigned int first_event, total_events;
+
+    // Only goes up, the main thread resets its caches when it changes
+    unsigned int total_overflows;
+
+    // The inputs of the actions that were applied, the main thread measures their latency once it shows this frame
+    uint32_t input_times[MAX_PENDING_INPUTS];
+    unsigned int first_input_time, total_input_times;
+} simulation_frame_t;
+
+// Shared by both threads, so it can't live in the context
+typedef struct
+{
+    bool is_running;
+
+    SDL_Thread* thread;
+    SDL_sem* wakeup;
+    atomic_bool is_stopping;
+
+    spsc_queue_t actions;
+    triple_buffer_t frames;
+
+    // Only read by the simulation thread while it starts
+    savestate_t* starting_state;
+    int starting_players;
+
+    // Only touched by the simulation thread, rings of what was forwarded since the last confirmation of the main thread
+    // Every event and input time gets the next number, the rings hold the numbers from the confirmed one to the next one
+    game_event_t pending_events[MAX_FRAME_EVENTS];
+    unsigned int next_event;
+    unsigned int total_overflows;
+
+    uint32_t pending_input_times[MAX_PENDING_INPUTS];
+    unsigned int next_input_time;
+
+    // Written by the main thread after it handled a frame, the numbers it will never need again
+    atomic_uint confirmed_events, confirmed_input_times;
+
+    // Only touched by the main thread
+    unsigned int handled_events, handled_input_times;
+    unsigned int handled_overflows;
+} simulation_t;
+
+static simulation_t simulation;
+
+// Runs on the simulation thread
+static void forward_event(const game_event_t* event)
+{
+    unsigned int confirmed = atomic_load_explicit(&simulation.confirmed_events, memory_order_acquire);
+
+    // Nothing can be dropped before the main thread confirms it, so this only happens if it stops syncing for a long time
+    if (!event || simulation.next_event - confirmed == MAX_FRAME_EVENTS)
+    {
+        simulation.total_overflows++;
+        return;
+    }
+
+    simulation.pending_events[simulation.next_event++ % MAX_FRAME_EVENTS] = *event;
+}
+
+static void forward_input_time(uint32_t input_time)
+{
+    unsigned int confirmed = atomic_load_explicit(&simulation.confirmed_input_times, memory_order_acquire);
+
+    // Same as the old behaviour of the pending inputs of the game, a sample more or less doesn't matter
+    if (simulation.next_input_time - confirmed == MAX_PENDING_INPUTS) return;
+
+    simulation.pending_input_times[simulation.next_input_time++ % MAX_PENDING_INPUTS] = input_time;
+}
+
+static void publish_frame()
+{
+    simulation_frame_t* frame = get_back_buffer(&simulation.frames);
+    save_state(&frame->state);
+
+    // Everything after the last confirmation, in order
+    frame->first_event = atomic_load_explicit(&simulation.confirmed_events, memory_order_acquire);
+    frame->total_events = simulation.next_event - frame->first_event;
+
+    for (unsigned int i = 0; i < frame->total_events; i++)
+        frame->events[i] = simulation.pending_events[(frame->first_event + i) % MAX_FRAME_EVENTS];
+
+    frame->total_overflows = simulation.total_overflows;
+
+    frame->first_input_time = atomic_load_explicit(&simulation.confirmed_input_times, memory_order_acquire);
+    frame->total_input_times = simulation.next_input_time - frame->first_input_time;
+
+    for (unsigned int i = 0; i < frame->total_input_times; i++)
+        frame->input_times[i] = simulation.pending_input_times[(frame->first_input_time + i) % MAX_PENDING_INPUTS];
+
+    publish_back_buffer(&simulation.frames);
+}
+
+static int run_simulation(void* data)
+{
+    // This thread starts with an empty context of its own
+    ctx.starting_players = simulation.starting_players;
+
+    load_state(simulation.starting_state);
+    free(simulation.starting_state);
+
+    // The main thread already has this state, so the reset of the load isn't news
+    dispatch_events();
+    subscribe_to_events(FORWARDED_EVENTS, forward_event);
+
+    for (;;)
+    {
+        SDL_SemWait(simulation.wakeup);
+
+        if (atomic_load(&simulation.is_stopping)) break;
+
+        // Everything that was queued in the meantime is applied before publishing once
+        action_t action;
+        bool has_changed = false;
+
+        while (pop_from_queue(&simulation.actions, &action))
+        {
+            if (!apply_action(&action)) continue;
+
+            if (action.input_time)
+                forward_input_time(action.input_time);
+
+            has_changed = true;
+        }
+
+        if (!has_changed) continue;
+
+        dispatch_events();
+        publish_frame();
+    }
+
+    free_game_state();
+    return 0;
+}
+
+void start_simulation()
+{
+    assert_panic(simulation.is_running, "The simulation is already running");
+
+    create_spsc_queue(&simulation.actions, sizeof(action_t), MAX_QUEUED_ACTIONS);
+    create_triple_buffer(&simulation.frames, sizeof(simulation_frame_t));
+
+    simulation.wakeup = SDL_CreateSemaphore(0);
+    atomic_init(&simulation.is_stopping, false);
+
+    simulation.next_event = simulation.handled_events = 0;
+    simulation.next_input_time = simulation.handled_input_times = 0;
+    simulation.total_overflows = simulation.handled_overflows = 0;
+    atomic_init(&simulation.confirmed_events, 0);
+    atomic_init(&simulation.confirmed_input_times, 0);
+
+    // It's big, so it's handed over on the heap and freed by the simulation thread
+    simulation.starting_state = malloc(sizeof(savestate_t));
+    simulation.starting_players = ctx.starting_players;
+    save_state(simulation.starting_state);
+
+    simulation.thread = SDL_CreateThread(run_simulation, "simulation", NULL);
+    assert_panic(!simulation.thread, "Couldn't start the simulation thread");
+
+    simulation.is_running = true;
+}
+
+void stop_simulation()
+{
+    if (!simulation.is_running) return;
+
+    atomic_store(&simulation.is_stopping, true);
+    SDL_SemPost(simulation.wakeup);
+    SDL_WaitThread(simulation.thread, NULL);
+
+    SDL_DestroySemaphore(simulation.wakeup);
+    destroy_spsc_queue(&simulation.actions);
+    destroy_triple_buffer(&simulation.frames);
+
+    simulation.is_running = false;
+}
+
+bool is_simulation_running()
+{
+    return simulation.is_running;
+}
+
+bool queue_action(const action_t* action)
+{
+    if (!push_to_queue(&simulation.actions, action)) return false;
+
+    SDL_SemPost(simulation.wakeup);
+    return true;
+}
+
+void sync_simulation()
+{
+    if (!simulation.is_running) return;
+
+    simulation_frame_t* frame = acquire_front_buffer(&simulation.frames);
+    if (!frame) return;
+
+    sync_to_state(&frame->state);
+
+    if (frame->total_overflows != simulation.handled_overflows)
+    {
+        simulation.handled_overflows = frame->total_overflows;
+        publish_reset_event();
+    }
+
+    // An earlier frame may have had some of these already
+    for (unsigned int i = simulation.handled_events - frame->first_event; i < frame->total_events; i++)
+        publish_event(frame->events[i]);
+
+    for (unsigned int i = simulation.handled_input_times - frame->first_input_time; i < frame->total_input_times; i++)
+        track_input_latency(&ctx.game, frame->input_times[i]);
+
+    simulation.handled_events = frame->first_event + frame->total_events;
+    simulation.handled_input_times = frame->first_input_time + frame->total_input_times;
+
+    atomic_store_explicit(&simulation.confirmed_events, simulation.handled_events, memory_order_release);
+    atomic_store_explicit(&simulation.confirmed_input_times, simulation.handled_input_times, memory_order_release);
+}
@@ -0,0 +1,36 @@
+#ifndef _SIMULATION_H
+#define _SIMULATION_H
+
+#include <stdbool.h>
+#include "actions.h"
+
+/*
+ * Local games run the rules on their own thread, so a long turn change never freezes the window
+ * The simulation thread has its own context (see THREAD_LOCAL_CONTEXT). The actions of the player reach it through
+ * a lock-free queue and after every batch it publishes a copy of its state and its events through a triple buffer
+ * Once per frame the main thread syncs its own context to the latest copy, so the rendering code doesn't change at all
+ *
+ * Network games stay on a single thread, the checksums of lockstep need the state of the actions they were sent with
+ */
+
+// How many actions can wait for the simulation thread, more clicks than that are dropped
+#define MAX_QUEUED_ACTIONS 256
+
+// The structural changes (tiles, owners and stacks) are found again by sync_to_state when the main thread catches up,
+// only these explain how they happened so they are handed over as they are
+#define FORWARDED_EVENTS (EVENT_BIT(EVENT_STACK_MOVED) | EVENT_BIT(EVENT_STACK_MERGED) | EVENT_BIT(EVENT_SOLDIERS_TRAINED) \
+    | EVENT_BIT(EVENT_BATTLE) | EVENT_BIT(EVENT_PLAYER_ELIMINATED) | EVENT_BIT(EVENT_TURN_ENDED))
+
+// The simulation starts from the current state of the game, so the game has to be started first
+void start_simulation();
+void stop_simulation();
+
+bool is_simulation_running();
+
+// Returns false if the queue is full, the action is checked by the rules once the simulation gets to it
+bool queue_action(const action_t* action);
+
+// Called once per frame before dispatch_events, does nothing if the simulation hasn't published anything new
+void sync_simulation();
+
+#endif
@@ -1,9 +1,14 @@
 #include "soldiers.h"
 #include "engine/utils.h"
-#include "engine/audio.h"
 #include "context.h"
 #include "hex_utils.h"
 
+const soldier_kind_t soldier_kinds[NUM_SOLDIERS] = {
+#define SOLDIER_KIND(name, cost, moves, flags) [SOLDIER_##name] = {cost, moves, flags},
+#include "soldier_kinds.def"
+#undef SOLDIER_KIND
+};
+
 // Assigns the soldiers' current_tile and moves the units label accordingly
 void place_soldiers(soldiers_t* soldiers, tile_t* tile)
 {
@@ -16,13 +21,13 @@ void place_soldiers(soldiers_t* soldiers, tile_t* tile)
 void update_soldiers_texture(soldiers_t* soldiers)
 {
     // If it's sea, pick a ship texture
-    if (soldiers->current_tile->kind == TILE_WATER)
+    if (tile_kinds[soldiers->current_tile->kind].flags & TILE_IS_SEA)
     {
-        soldiers->source_rect.x = (soldiers->current_tile->owner_id + 2) * TILE_WIDTH;
+        soldiers->source_rect.x = ctx.soldiers_region.x + (soldiers->current_tile->owner_id + 2) * TILE_WIDTH;
     }
     else
     {
-        soldiers->source_rect.x = soldiers->kind * TILE_WIDTH;
+        soldiers->source_rect.x = ctx.soldiers_region.x + soldiers->kind * TILE_WIDTH;
     }
 }
 
@@ -45,27 +50,32 @@ bool try_to_train_soldiers(int tile_x, int tile_y, soldier_kind_e choice)
     tile_t* tile = &ctx.tilemap[tile_y][tile_x];
     player_t* current_player = &ctx.players[ctx.current_player_id];
     
-    int cost = SOLDIER_COSTS[choice];
+    int cost = soldier_kinds[choice].cost;
     if (current_player->coins < cost) return false;
 
-    switch (choice)
+    // Soldiers without units can only be trained on an empty city, the others join the stack of the same kind
+    if (!(soldier_kinds[choice].flags & SOLDIER_HAS_UNITS))
     {
-        case SOLDIER_SABOTEUR:
-            if (tile->soldiers) return false;
-
-            tile->soldiers = create_soldiers(tile_x, tile_y, choice);
+        if (tile->soldiers) return false;
 
-            break;
-
-        case SOLDIER_KNIGHT:
-            if (!tile->soldiers)
-                create_soldiers(tile_x, tile_y, choice);
-            else
-                set_soldier_units(tile->soldiers, tile->soldiers->units + KNIGHTS_PER_TRAIN);
+        create_soldiers(tile_x, tile_y, choice);
+    }
+    else
+    {
+        unsigned int old_units = 0;
 
-            current_player->total_units += KNIGHTS_PER_TRAIN;
+        if (!tile->soldiers)
+            create_soldiers(tile_x, tile_y, choice);
+        else if (tile->soldiers->kind != choice)
+            return false;
+        else
+        {
+            old_units = tile->soldiers->units;
+            set_soldier_units(tile->soldiers, old_units + KNIGHTS_PER_TRAIN);
+        }
 
-            break;
+        // Full stacks don't grow past MAX_UNITS, so only the units that actually joined are counted
+        current_player->total_units += tile->soldiers->units - old_units;
     }
 
     current_player->coins -= cost;    
@@ -85,32 +95,30 @@ void capture_tile(int tile_x, int tile_y, int sender_id)
     if (!was_neutral)
         ctx.players[tile->owner_id].total_territories--; 
 
-    // Handle some special cases
-    switch (tile->kind)
-    {
-        case TILE_FARM:
-        case TILE_BROKEN_FARM:
-            // I don't need to check if it's owned, but just in case
-            if (!was_neutral) ctx.players[tile->owner_id].total_farms--;
-        
-            set_tile_kind(tile_x, tile_y, TILE_GRASS);
+    // Handle some special cases, farms are destroyed and fish are collected
+    const tile_kind_t* kind = &tile_kinds[tile->kind];
 
-            break;
+    // I don't need to check if farms are owned, but just in case
+    if (kind->flags & TILE_IS_FARM && !was_neutral)
+        ctx.players[tile->owner_id].total_farms--;
 
-        case TILE_FISH:
-            set_tile_kind(tile_x, tile_y, TILE_WATER);
-            ctx.players[sender_id].coins += FISH_INCOME;
-            
-            break;
+    if (kind->flags & TILE_IS_CITY)
+    {
+        if (!was_neutral) ctx.players[tile->owner_id].total_cities--;
+        ctx.players[sender_id].total_cities++;
 
-        case TILE_CITY:
-            if (!was_neutral) ctx.players[tile->owner_id].total_cities--;
-            ctx.players[sender_id].total_cities++;
-            
-            break;
+        set_city_owner(tile->city_id, tile->owner_id, sender_id);
     }
 
+    ctx.players[sender_id].coins += kind->capture_coins;
+
+    if (kind->captured_kind != tile->kind)
+        set_tile_kind(tile_x, tile_y, kind->captured_kind);
+
+    int previous_owner_id = tile->owner_id;
     tile->owner_id = sender_id;
+
+    publish_event((game_event_t) {EVENT_TILE_CAPTURED, tile_x, tile_y, .player_id = sender_id, .value = previous_owner_id});
 }
 
 soldiers_t* create_soldiers(int tile_x, int tile_y, soldier_kind_e kind)
@@ -119,7 +127,7 @@ soldiers_t* create_soldiers(int tile_x, int tile_y, soldier_kind_e kind)
     soldiers_t* soldiers = malloc(sizeof(soldiers_t));
 
     soldiers->kind = kind;
-    soldiers->source_rect = (SDL_Rect) {kind * TILE_WIDTH, 0, TILE_WIDTH, TILE_HEIGHT};
+    soldiers->source_rect = get_atlas_rect(&ctx.soldiers_region, kind * TILE_WIDTH, 0, TILE_WIDTH, TILE_HEIGHT);
 
     // Have to do this before place_soldiers because we must first be able to initialize the text
     soldiers->current_tile = &ctx.tilemap[tile_y][tile_x];
@@ -128,7 +136,11 @@ soldiers_t* create_soldiers(int tile_x, int tile_y, soldier_kind_e kind)
     soldiers->remaining_moves = 0;
     soldiers->units = 0;
 
-    if (kind == SOLDIER_KNIGHT)
+    // Nothing to slide from yet
+    soldiers->slide_origin = (SDL_Point) {soldiers->current_tile->dest_rect.x, soldiers->current_tile->dest_rect.y};
+    soldiers->slide_start_time = 0;
+
+    if (soldier_kinds[kind].flags & SOLDIER_HAS_UNITS)
     {
         create_label(&soldiers->units_label, ctx.font, 0);
         set_soldier_units(soldiers, KNIGHTS_PER_TRAIN);
@@ -136,19 +148,11 @@ soldiers_t* create_soldiers(int tile_x, int tile_y, soldier_kind_e kind)
 
     // Will position the text too
     place_soldiers(soldiers, &ctx.tilemap[tile_y][tile_x]);
+    publish_event((game_event_t) {EVENT_STACK_CREATED, tile_x, tile_y});
 
     return soldiers;
 }
 
-// Unrelated function that creates an explosion
-void activate_explosion(int pos_x, int pos_y)
-{
-    set_transform_position(&ctx.explosion.sprite.transform, pos_x - 16, pos_y - 16);
-    play_animated_sprite(&ctx.explosion);// Making it into a constant because it might change in the future
-    
-    play_audio(ctx.cannon_sfx);
-}
-
 void capture_empty_neighbours(int sender_id, int tile_x, int tile_y)
 {
     // Capture empty neighbouring tiles
@@ -161,7 +165,7 @@ void capture_empty_neighbours(int sender_id, int tile_x, int tile_y)
 
         tile_t* tile = &ctx.tilemap[y][x];
 
-        if (!tile->soldiers && tile->kind != TILE_CITY && !is_water(x, y) && tile->kind != TILE_FARM)
+        if (!tile->soldiers && tile_kinds[tile->kind].flags & TILE_CLAIMED_AROUND)
         {
             capture_tile(x, y, sender_id);
         }
@@ -171,6 +175,7 @@ void capture_empty_neighbours(int sender_id, int tile_x, int tile_y)
 void conquer_player(int attacker_id, int loser_id)
 {
     ctx.players[loser_id].is_dead = true;
+    publish_event((game_event_t) {EVENT_PLAYER_ELIMINATED, .player_id = loser_id, .value = attacker_id});
 
     MAP_FOREACH(x, y)
     {
@@ -178,7 +183,17 @@ void conquer_player(int attacker_id, int loser_id)
 
         if (tile->owner_id == loser_id && !is_water(x, y))
         {
+            // The surviving armies switch sides, but the capital's defenders are accounted for by the battle
+            if (tile->soldiers && soldier_kinds[tile->soldiers->kind].flags & SOLDIER_HAS_UNITS && !tile->is_capital)
+            {
+                ctx.players[loser_id].total_units -= tile->soldiers->units;
+                ctx.players[attacker_id].total_units += tile->soldiers->units;
+            }
+
             capture_tile(x, y, attacker_id);
+
+            // Otherwise taking this tile later would conquer the attacker too
+            tile->is_capital = false;
         }
     }
 }
@@ -192,12 +207,15 @@ bool move_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
     int sender_id = soldiers->current_tile->owner_id;
     int enemy_id = tile->owner_id;
 
+    int source_index = soldiers->current_tile - &ctx.tilemap[0][0];
+    int source_x = source_index % TILEMAP_WIDTH, source_y = source_index / TILEMAP_WIDTH;
+
     // Check if the soldiers are trying to move to a sea tile without being on a port when on land
-    if (is_water(tile_x, tile_y) && (soldiers->current_tile->kind != TILE_PORT && soldiers->current_tile->kind != TILE_WATER))
+    if (is_water(tile_x, tile_y) && !(tile_kinds[soldiers->current_tile->kind].flags & TILE_LAUNCHES_SHIPS))
         return false;
 
     // Stores if the soldiers go from ship to land or from land to ship so it can update the texture later (XOR operator)
-    bool will_change_surface = is_water(tile_x, tile_y) ^ (soldiers->current_tile->kind == TILE_WATER);
+    bool will_change_surface = is_water(tile_x, tile_y) ^ is_water(source_x, source_y);
 
     unsigned int new_remaining_moves = soldiers->remaining_moves - 1;
 
@@ -206,7 +224,8 @@ bool move_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
         if (enemy_id != sender_id)
         {
             // Saboteurs can only claim empty land and farms
-            if (soldiers->kind == SOLDIER_SABOTEUR && tile->kind == TILE_CITY) return false;
+            if (!(soldier_kinds[soldiers->kind].flags & SOLDIER_CAPTURES_CITIES) && tile_kinds[tile->kind].flags & TILE_IS_CITY)
+                return false;
             
 
             if (tile->is_capital)
@@ -220,23 +239,18 @@ bool move_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
         place_soldiers(soldiers, tile);
         soldiers->remaining_moves = new_remaining_moves;
 
-        if (soldiers->kind != SOLDIER_SABOTEUR)
-            capture_empty_neighbours(sender_id, tile_x, tile_y);
+        move_surface_e surface = MOVE_ON_SURFACE;
 
         if (will_change_surface)
         {
-            // Play the shipbell sound when a new ship is created
-            if (soldiers->current_tile->kind == TILE_WATER)
-            {
-                play_audio(ctx.shipbell_sfx);
-            }
-
+            surface = is_water(tile_x, tile_y) ? MOVE_BOARDED_SHIP : MOVE_LANDED;
             update_soldiers_texture(soldiers);
         }
-        else
-        {
-            play_audio(ctx.dirt_sfx);
-        }
+
+        publish_event((game_event_t) {EVENT_STACK_MOVED, source_x, source_y, tile_x, tile_y, sender_id, surface});
+
+        if (soldier_kinds[soldiers->kind].flags & SOLDIER_CLAIMS_AROUND)
+            capture_empty_neighbours(sender_id, tile_x, tile_y);
 
         return true;
     }
@@ -244,8 +258,8 @@ bool move_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
      // Check if it's just a move between soldiers of the same player
     if (enemy_id == sender_id)
     {
-        // Can only combine soldiers of the same type
-        if (tile->soldiers->kind != soldiers->kind) return false;
+        // Can only combine soldiers of the same type, and saboteurs don't have units to combine
+        if (tile->soldiers->kind != soldiers->kind || !(soldier_kinds[soldiers->kind].flags & SOLDIER_HAS_UNITS)) return false;
 
         if (tile->soldiers->units == MAX_UNITS) return false;
 
@@ -264,11 +278,14 @@ bool move_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
             soldiers->remaining_moves = new_remaining_moves;
         }
 
+        publish_event((game_event_t) {EVENT_STACK_MERGED, source_x, source_y, tile_x, tile_y, sender_id});
+
         return true;
     }
 
     // Handling battles
-    bool is_saboteur_involved = soldiers->kind == SOLDIER_SABOTEUR || tile->soldiers->kind == SOLDIER_SABOTEUR;
+    bool is_saboteur_involved = !(soldier_kinds[soldiers->kind].flags & soldier_kinds[tile->soldiers->kind].flags & SOLDIER_HAS_UNITS);
+    soldier_kind_e attacker_kind = soldiers->kind;
 
     int attack_result = tile->soldiers->units - soldiers->units;
     int total_killed = MIN(tile->soldiers->units, soldiers->units);
@@ -288,18 +305,15 @@ bool move_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
     {    
         // Conquering a capital should kill the player and make his kingdom part of the attacker's
         if (tile->is_capital)
-        {
-            tile->is_capital = false;
             conquer_player(sender_id, enemy_id);
-        }
         else
             capture_tile(tile_x, tile_y, sender_id);
 
         // If the enemy was a saboteur, make turn him into a knight
-        if (tile->soldiers->kind == SOLDIER_SABOTEUR)
+        if (!(soldier_kinds[tile->soldiers->kind].flags & SOLDIER_HAS_UNITS))
         {
             create_label(&tile->soldiers->units_label, ctx.font, 0);
-            tile->soldiers->kind = SOLDIER_KNIGHT;
+            tile->soldiers->kind = attacker_kind;
         }
 
         set_soldier_units(tile->soldiers, -attack_result);
@@ -314,7 +328,7 @@ bool move_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
         ctx.players[enemy_id].total_units -= total_killed;
     }
 
-    activate_explosion(tile->dest_rect.x, tile->dest_rect.y);
+    publish_event((game_event_t) {EVENT_BATTLE, tile_x, tile_y, source_x, source_y, sender_id});
     
     return true;
 }
@@ -325,12 +339,14 @@ void select_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
     if (soldiers->current_tile->owner_id != ctx.current_player_id) return;
 
     ctx.selected_soldiers = soldiers;
+    ctx.selected_x = tile_x;
+    ctx.selected_y = tile_y;
 
     // Highlighting neighbour tiles
     memset(&ctx.highlighted_tiles, 0, TOTAL_HIGHLIGHTED * sizeof(tile_t*));
 
     tile_t* source = &ctx.tilemap[tile_y][tile_x];
-    bool can_move_to_sea = soldiers->current_tile->kind == TILE_WATER || soldiers->current_tile->kind == TILE_PORT;
+    bool can_move_to_sea = tile_kinds[soldiers->current_tile->kind].flags & TILE_LAUNCHES_SHIPS;
 
     // Highlighting neighbours
     unsigned int total_highlighted = 0;
@@ -350,7 +366,38 @@ void select_soldiers(soldiers_t* soldiers, int tile_x, int tile_y)
     }
 }
 
-void render_soldiers(soldiers_t* soldiers, SDL_Renderer* renderer, SDL_Texture* soldiers_texture)
+// Where the stack is drawn at the time, in world coordinates
+static SDL_Point get_soldiers_position(const soldiers_t* soldiers, uint32_t time)
+{
+    const SDL_Rect* tile_rect = &soldiers->current_tile->dest_rect;
+    uint32_t elapsed_time = time - soldiers->slide_start_time;
+
+    if (soldiers->slide_start_time == 0 || elapsed_time >= SOLDIERS_SLIDE_MS)
+        return (SDL_Point) {tile_rect->x, tile_rect->y};
+
+    // Slowing down towards the end looks less mechanical
+    float progress = (float) elapsed_time / SOLDIERS_SLIDE_MS;
+    progress = 1 - (1 - progress) * (1 - progress);
+
+    return (SDL_Point) {
+        soldiers->slide_origin.x + (int) ((tile_rect->x - soldiers->slide_origin.x) * progress),
+        soldiers->slide_origin.y + (int) ((tile_rect->y - soldiers->slide_origin.y) * progress),
+    };
+}
+
+void slide_soldiers(soldiers_t* soldiers, const tile_t* from_tile, uint32_t time)
+{
+    // The stack was already sliding, so it continues from where it is instead of jumping back
+    if (soldiers->slide_start_time != 0 && time - soldiers->slide_start_time < SOLDIERS_SLIDE_MS)
+        soldiers->slide_origin = get_soldiers_position(soldiers, time);
+    else
+        soldiers->slide_origin = (SDL_Point) {from_tile->dest_rect.x, from_tile->dest_rect.y};
+
+    // Zero means that it never slid
+    soldiers->slide_start_time = time ? time : 1;
+}
+
+void render_soldiers(soldiers_t* soldiers, SDL_Renderer* renderer, SDL_Texture* soldiers_texture, uint32_t time)
 {
     // Visual indication that the soldier cannot be moved
     if (soldiers->remaining_moves == 0)
@@ -358,10 +405,26 @@ void render_soldiers(soldiers_t* soldiers, SDL_Renderer* renderer, SDL_Texture*
     else
         SDL_SetTextureColorMod(soldiers_texture, 255, 255, 255);
 
-    SDL_RenderCopy(renderer, soldiers_texture, &soldiers->source_rect, &soldiers->current_tile->dest_rect);
+    // The label was placed on the tile, it moves along with the stack
+    SDL_Point position = get_soldiers_position(soldiers, time);
+    int offset_x = position.x - soldiers->current_tile->dest_rect.x;
+    int offset_y = position.y - soldiers->current_tile->dest_rect.y;
+
+    SDL_Rect world_rect = {position.x, position.y, TILE_WIDTH, TILE_HEIGHT};
+    SDL_Rect dest_rect = world_to_screen_rect(&ctx.camera, &world_rect);
+    SDL_RenderCopy(renderer, soldiers_texture, &soldiers->source_rect, &dest_rect);
+
+    if (soldier_kinds[soldiers->kind].flags & SOLDIER_HAS_UNITS)
+    {
+        sprite_t* label = &soldiers->units_label.sprite;
 
-    if (soldiers->kind == SOLDIER_KNIGHT)
-        render_sprite(&soldiers->units_label.sprite, renderer);
+        SDL_Rect label_rect = label->transform.rect;
+        label_rect.x += offset_x;
+        label_rect.y += offset_y;
+
+        label_rect = world_to_screen_rect(&ctx.camera, &label_rect);
+        SDL_RenderCopy(renderer, label->texture, &label->source_rect, &label_rect);
+    }
 }
 
 void clear_selected_soldiers()
@@ -373,10 +436,13 @@ void clear_selected_soldiers()
 
 void destroy_soldiers(soldiers_t* soldiers)
 {
-    if (soldiers->kind == SOLDIER_KNIGHT)
+    if (soldier_kinds[soldiers->kind].flags & SOLDIER_HAS_UNITS)
         destroy_label(&soldiers->units_label);
 
+    int index = soldiers->current_tile - &ctx.tilemap[0][0];
+
     soldiers->current_tile->soldiers = NULL;
+    publish_event((game_event_t) {EVENT_STACK_DESTROYED, index % TILEMAP_WIDTH, index / TILEMAP_WIDTH});
 
     free(soldiers);
 }
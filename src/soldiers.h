@@ -1,22 +1,53 @@
 #ifndef _SOLDIERS_H
 #define _SOLDIERS_H
 
+#include <stdint.h>
 #include "engine/interface.h"
 
 // Forward decleration
 struct tile_t;
 
+#ifndef KNIGHT_COST
+#define KNIGHT_COST 10
+#endif
+
+#ifndef SABOTEUR_COST
+#define SABOTEUR_COST 20
+#endif
+
+// What the rules check about a kind, the kinds themselves are listed in soldier_kinds.def
+typedef enum
+{
+    // Stacks with units can be merged and trained again, they fight with their units
+    SOLDIER_HAS_UNITS = 1 << 0,
+
+    SOLDIER_CAPTURES_CITIES = 1 << 1,
+
+    // Moving captures the empty tiles around the new tile
+    SOLDIER_CLAIMS_AROUND = 1 << 2,
+} soldier_flags_e;
+
 typedef enum
 {
-    SOLDIER_KNIGHT,
-    SOLDIER_SABOTEUR,
+#define SOLDIER_KIND(name, ...) SOLDIER_##name,
+#include "soldier_kinds.def"
+#undef SOLDIER_KIND
 
     NUM_SOLDIERS,
 } soldier_kind_e;
 
-// Constant cost of training per soldier kind and starting moves
-static int SOLDIER_COSTS[NUM_SOLDIERS] = {10, 20};
-static int SOLDIER_MOVES[NUM_SOLDIERS] = {2, 5};
+// Constant cost of training and moves per turn
+typedef struct
+{
+    uint16_t cost;
+    uint8_t moves;
+    uint8_t flags;
+} soldier_kind_t;
+
+extern const soldier_kind_t soldier_kinds[NUM_SOLDIERS];
+
+// How long a stack takes to slide to its new tile on the screen
+#define SOLDIERS_SLIDE_MS 150
 
 typedef struct soldiers_t
 {
@@ -30,11 +61,19 @@ typedef struct soldiers_t
 
     soldier_kind_e kind;
     struct tile_t* current_tile;
+
+    // Only for rendering, the rules just look at current_tile
+    // The stack is drawn sliding from slide_origin (world position) to its tile during SOLDIERS_SLIDE_MS
+    SDL_Point slide_origin;
+    uint32_t slide_start_time;
 } soldiers_t;
 
 soldiers_t* create_soldiers(int tile_x, int tile_y, soldier_kind_e kind);
 void set_soldier_units(soldiers_t* soldiers, unsigned int units);
 
+// Picks the ship texture when they are on water
+void update_soldiers_texture(soldiers_t* soldiers);
+
 // Just places the soldiers on an empty tile (used by initialization)
 void place_soldiers(soldiers_t* soldiers, struct tile_t* tile);
 
@@ -47,11 +86,18 @@ bool try_to_train_soldiers(int tile_x, int tile_y, soldier_kind_e choice);
 // Includes validation too
 void select_soldiers(soldiers_t* soldiers, int tile_x, int tile_y);
 
-void render_soldiers(soldiers_t* soldiers, SDL_Renderer* renderer, SDL_Texture* soldiers_texture);
+// Starts sliding from where the stack is drawn right now (so a slide can be interrupted) or from the given tile
+void slide_soldiers(soldiers_t* soldiers, const struct tile_t* from_tile, uint32_t time);
+
+// The time is the one of the frame, so that every stack is drawn at the same point of its slide
+void render_soldiers(soldiers_t* soldiers, SDL_Renderer* renderer, SDL_Texture* soldiers_texture, uint32_t time);
 
 // Sets the tile owner to sender_id and adjusts total territories
 void capture_tile(int tile_x, int tile_y, int sender_id);
 
+// Hands every land tile of the loser to the attacker, his armies switch sides too
+void conquer_player(int attacker_id, int loser_id);
+
 void clear_selected_soldiers();
 void destroy_soldiers(soldiers_t* soldiers);
 
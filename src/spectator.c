@@ -0,0 +1,278 @@
+#include <string.h>
+
+#include "context.h"
+#include "spectator.h"
+#include "engine/utils.h"
+
+// Every tile changing at once is the worst case, each one can't take more than 8 bytes with its run header
+#define MAX_FRAME_SIZE (TILEMAP_WIDTH * TILEMAP_HEIGHT * 8 + TOTAL_PLAYERS * 40 + 64)
+
+static uint32_t zigzag(int value)
+{
+    // Small negative numbers should stay small
+    return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+// This is the only part that runs on the game thread
+static void capture_turn_state(turn_state_t* state)
+{
+    state->turn = ctx.turn;
+    state->current_player_id = ctx.current_player_id;
+
+    for (int i = 0; i < TOTAL_PLAYERS; i++)
+    {
+        player_t* player = &ctx.players[i];
+
+        state->players[i] = (player_state_t) {
+            player->is_dead, player->coins, player->income,
+            player->total_territories, player->total_units, player->total_cities, player->total_farms,
+        };
+    }
+
+    tile_state_t* tile_state = state->tiles;
+
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+        soldiers_t* soldiers = tile->soldiers;
+
+        tile_state->tile = tile->kind | (tile->owner_id + 1) << 4 | tile->is_capital << 7;
+        tile_state->soldiers = soldiers ? (soldiers->kind + 1) | soldiers->remaining_moves << 2 : 0;
+        tile_state->units = soldiers ? soldiers->units : 0;
+
+        tile_state++;
+    }
+}
+
+static bool are_players_equal(player_state_t* first, player_state_t* second)
+{
+    return first->is_dead == second->is_dead && first->coins == second->coins && first->income == second->income
+        && first->territories == second->territories && first->units == second->units
+        && first->cities == second->cities && first->farms == second->farms;
+}
+
+// The writer has nothing to do while both are equal, a frame of them would be empty
+static bool are_turn_states_equal(turn_state_t* first, turn_state_t* second)
+{
+    if (first->turn != second->turn || first->current_player_id != second->current_player_id) return false;
+
+    for (int i = 0; i < TOTAL_PLAYERS; i++)
+    {
+        if (!are_players_equal(&first->players[i], &second->players[i])) return false;
+    }
+
+    return memcmp(first->tiles, second->tiles, TILEMAP_WIDTH * TILEMAP_HEIGHT * sizeof(tile_state_t)) == 0;
+}
+
+// Returns the size of the frame body
+static int encode_frame(uint8_t* buffer, turn_state_t* current, turn_state_t* previous)
+{
+    int length = 0;
+
+    length += write_varint(buffer + length, current->turn);
+    buffer[length++] = current->current_player_id;
+
+    // Players
+    uint8_t* mask = &buffer[length++];
+    *mask = 0;
+
+    for (int i = 0; i < TOTAL_PLAYERS; i++)
+    {
+        player_state_t* player = &current->players[i];
+        if (are_players_equal(player, &previous->players[i])) continue;
+
+        *mask |= 1 << i;
+
+        buffer[length++] = player->is_dead;
+        length += write_varint(buffer + length, zigzag(player->coins));
+        length += write_varint(buffer + length, zigzag(player->income));
+        length += write_varint(buffer + length, player->territories);
+        length += write_varint(buffer + length, player->units);
+        length += write_varint(buffer + length, player->cities);
+        length += write_varint(buffer + length, player->farms);
+    }
+
+    // Tiles are written as runs, so that untouched parts of the map cost almost nothing
+    int total_tiles = TILEMAP_WIDTH * TILEMAP_HEIGHT;
+    int index = 0;
+
+    for (;;)
+    {
+        int start = index;
+
+        while (index < total_tiles && memcmp(&current->tiles[index], &previous->tiles[index], sizeof(tile_state_t)) == 0)
+            index++;
+
+        int run_start = index;
+
+        while (index < total_tiles && memcmp(&current->tiles[index], &previous->tiles[index], sizeof(tile_state_t)) != 0)
+            index++;
+
+        length += write_varint(buffer + length, run_start - start);
+        length += write_varint(buffer + length, index - run_start);
+
+        // The terminating pair has an empty run
+        if (index == run_start) break;
+
+        for (int i = run_start; i < index; i++)
+        {
+            tile_state_t* tile = &current->tiles[i];
+
+            buffer[length++] = tile->tile;
+            buffer[length++] = tile->soldiers;
+
+            if (tile->soldiers)
+                length += write_varint(buffer + length, tile->units);
+        }
+    }
+
+    return length;
+}
+
+static int write_frames(void* data)
+{
+    spectator_t* spectator = data;
+
+    SDL_LockMutex(spectator->lock);
+
+    for (;;)
+    {
+        while (!spectator->has_pending && !spectator->should_stop)
+            SDL_CondWait(spectator->condition, spectator->lock);
+
+        if (!spectator->has_pending) break;
+
+        // The game doesn't touch the pending state until has_pending is cleared, so it can be read without the lock
+        SDL_UnlockMutex(spectator->lock);
+
+        // Leaving some room in front of the body for its length
+        uint8_t* body = spectator->frame_buffer + 5;
+        int body_length = encode_frame(body, &spectator->pending, &spectator->previous);
+
+        uint8_t prefix[5];
+        int prefix_length = write_varint(prefix, body_length);
+
+        memcpy(body - prefix_length, prefix, prefix_length);
+        fwrite(body - prefix_length, 1, prefix_length + body_length, spectator->file);
+
+        // Readers on the other side of a pipe want the turn as soon as possible
+        fflush(spectator->file);
+
+        SDL_LockMutex(spectator->lock);
+
+        turn_state_t written = spectator->pending;
+        spectator->pending = spectator->previous;
+        spectator->previous = written;
+
+        spectator->has_pending = false;
+        SDL_CondBroadcast(spectator->condition);
+    }
+
+    SDL_UnlockMutex(spectator->lock);
+
+    return 0;
+}
+
+void start_spectator_stream(const char* path)
+{
+    spectator_t* spectator = &ctx.spectator;
+
+    spectator->file = fopen(path, "wb");
+    assert_panic(!spectator->file, "Couldn't open the spectator stream file");
+
+    int total_tiles = TILEMAP_WIDTH * TILEMAP_HEIGHT;
+
+    spectator->pending.tiles = malloc(total_tiles * sizeof(tile_state_t));
+    spectator->previous.tiles = malloc(total_tiles * sizeof(tile_state_t));
+    spectator->frame_buffer = malloc(MAX_FRAME_SIZE);
+
+    // Impossible values, so that the first frame contains everything
+    memset(spectator->previous.tiles, 0xff, total_tiles * sizeof(tile_state_t));
+    memset(spectator->previous.players, 0xff, sizeof(spectator->previous.players));
+
+    uint8_t header[32];
+    int length = 0;
+
+    memcpy(header, SPECTATOR_MAGIC, 4);
+    length += 4;
+    header[length++] = SPECTATOR_VERSION;
+
+    length += write_varint(header + length, TILEMAP_WIDTH);
+    length += write_varint(header + length, TILEMAP_HEIGHT);
+    length += write_varint(header + length, ctx.starting_players);
+    length += write_varint(header + length, zigzag(ctx.map_seed));
+
+    fwrite(header, 1, length, spectator->file);
+
+    spectator->lock = SDL_CreateMutex();
+    spectator->condition = SDL_CreateCond();
+    spectator->writer = SDL_CreateThread(write_frames, "spectator", spectator);
+
+    spectator->is_active = true;
+
+    // Starting state
+    spectator->last_turn = ctx.turn - 1;
+    update_spectator_stream();
+}
+
+// The writer can be stuck on a pipe that nobody reads, so the game never waits for it while playing
+// A busy writer leaves last_turn as it is and the next frame tries again, the frames are changes so nothing is lost
+static void submit_turn_state(bool should_wait, bool only_if_changed)
+{
+    spectator_t* spectator = &ctx.spectator;
+
+    SDL_LockMutex(spectator->lock);
+
+    while (spectator->has_pending && should_wait)
+        SDL_CondWait(spectator->condition, spectator->lock);
+
+    bool is_busy = spectator->has_pending;
+    SDL_UnlockMutex(spectator->lock);
+
+    if (is_busy) return;
+
+    capture_turn_state(&spectator->pending);
+    spectator->last_turn = ctx.turn;
+
+    // The writer is idle, so previous is the state of the last frame it wrote
+    if (only_if_changed && are_turn_states_equal(&spectator->pending, &spectator->previous)) return;
+
+    SDL_LockMutex(spectator->lock);
+    spectator->has_pending = true;
+    SDL_CondBroadcast(spectator->condition);
+    SDL_UnlockMutex(spectator->lock);
+}
+
+void update_spectator_stream()
+{
+    if (!ctx.spectator.is_active || ctx.spectator.last_turn == ctx.turn) return;
+
+    submit_turn_state(false, false);
+}
+
+void stop_spectator_stream()
+{
+    spectator_t* spectator = &ctx.spectator;
+    if (!spectator->is_active) return;
+
+    // Whatever happened during the unfinished turn, the game is closing so waiting for the writer is fine
+    submit_turn_state(true, true);
+
+    SDL_LockMutex(spectator->lock);
+    spectator->should_stop = true;
+    SDL_CondBroadcast(spectator->condition);
+    SDL_UnlockMutex(spectator->lock);
+
+    SDL_WaitThread(spectator->writer, NULL);
+
+    fclose(spectator->file);
+
+    free(spectator->pending.tiles);
+    free(spectator->previous.tiles);
+    free(spectator->frame_buffer);
+
+    SDL_DestroyCond(spectator->condition);
+    SDL_DestroyMutex(spectator->lock);
+
+    spectator->is_active = false;
+}
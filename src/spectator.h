@@ -0,0 +1,80 @@
+#ifndef _SPECTATOR_H
+#define _SPECTATOR_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+/*
+ * Writes the game as a stream of per-turn changes so that it can be watched or archived without a window
+ * The game only copies a compact version of its state when a turn ends, comparing and writing happens on another thread
+ *
+ * Stream format (all numbers are varints, signed ones are zigzag encoded):
+ *   header:  "HXSP", version byte, width, height, total players, map seed
+ *   frame:   length of the rest of the frame, turn, current player, mask of changed players (1 byte)
+ *            for every changed player: is_dead byte, coins, income, territories, units, cities, farms
+ *            pairs of (unchanged tiles to skip, changed tiles that follow) until a pair with zero changed tiles
+ *            every changed tile is a tile byte, a soldiers byte and the units (only if there are soldiers)
+ *
+ * Tile byte: kind in the low 4 bits, owner + 1 in the next 3 and the capital flag on top
+ * Soldiers byte: 0 if empty, otherwise soldier kind + 1 in the low 2 bits and the remaining moves above them
+ * The first frame is compared against an empty map, so it contains the whole starting state
+ * Turns that end while the writer is still busy are skipped, the next frame then has the changes of all of them
+ */
+
+#define SPECTATOR_MAGIC "HXSP"
+#define SPECTATOR_VERSION 1
+
+typedef struct
+{
+    uint8_t tile;
+    uint8_t soldiers;
+    uint8_t units;
+} tile_state_t;
+
+typedef struct
+{
+    uint8_t is_dead;
+    int coins, income;
+    unsigned int territories, units, cities, farms;
+} player_state_t;
+
+// Everything that is compared between two turns
+typedef struct
+{
+    unsigned int turn;
+    int current_player_id;
+
+    player_state_t players[TOTAL_PLAYERS];
+    tile_state_t* tiles;
+} turn_state_t;
+
+typedef struct
+{
+    bool is_active;
+    FILE* file;
+
+    unsigned int last_turn;
+
+    // The game fills pending, the writer thread compares it with previous and then swaps them
+    turn_state_t pending, previous;
+    bool has_pending, should_stop;
+
+    uint8_t* frame_buffer;
+
+    SDL_Thread* writer;
+    SDL_mutex* lock;
+    SDL_cond* condition;
+} spectator_t;
+
+// Path can be a regular file or a named pipe
+void start_spectator_stream(const char* path);
+
+// Cheap to call every frame, it only does something once the turn has changed and it never waits for the writer
+void update_spectator_stream();
+
+// Writes the unfinished turn (only if something changed since the last frame) and closes the file
+void stop_spectator_stream();
+
+#endif
@@ -3,6 +3,15 @@
 #include "hex_utils.h"
 #include "context.h"
 #include "engine/sprite.h"
+#include "engine/utils.h"
+
+const tile_kind_t tile_kinds[NUM_TILE_KINDS] = {
+#define TILE_KIND(name, symbol, flags, captured_kind, capture_coins, income, minimap_color) \
+    [TILE_##name] = {symbol, flags, TILE_##captured_kind, capture_coins, income, \
+        {(minimap_color) >> 16 & 0xff, (minimap_color) >> 8 & 0xff, (minimap_color) & 0xff, 255}},
+#include "tile_kinds.def"
+#undef TILE_KIND
+};
 
 // Texture index refers to x position in tilemap texture
 void create_tile(int tile_x, int tile_y, tile_kind_e kind)
@@ -22,45 +31,198 @@ void set_tile_kind(int tile_x, int tile_y, tile_kind_e kind)
     tile_t* tile = &ctx.tilemap[tile_y][tile_x];
 
     tile->kind = kind;
+    publish_event((game_event_t) {EVENT_TILE_KIND_CHANGED, tile_x, tile_y});
 
-    if (kind != TILE_WATER)
-        tile->source_rect = (SDL_Rect) {kind * TILE_WIDTH, 0, TILE_WIDTH, TILE_HEIGHT};
+    if (tile_kinds[kind].flags & TILE_HAS_SPRITE)
+        tile->source_rect = get_atlas_rect(&ctx.tilemap_region, kind * TILE_WIDTH, 0, TILE_WIDTH, TILE_HEIGHT);
 }
 
-void create_city(int tile_x, int tile_y)
+// Pushes the city to the front of the list of the owner, the city can't be in a list already
+static void link_city(int city_id, int owner_id)
+{
+    city_t* city = &ctx.cities[city_id];
+    int* first = &ctx.first_owned_city[owner_id + 1];
+
+    if (*first)
+        ctx.cities[*first - 1].previous_owned = city_id + 1;
+
+    city->previous_owned = 0;
+    city->next_owned = *first;
+    *first = city_id + 1;
+}
+
+void create_city(int tile_x, int tile_y, int name_index)
 {
     tile_t* tile = &ctx.tilemap[tile_y][tile_x];
 
+    assert_panic(ctx.total_cities == MAX_CITIES, "Ran out of cities, increase MAX_CITIES");
+
+    int city_id = ctx.total_cities++;
+    city_t* city = &ctx.cities[city_id];
+
+    *city = (city_t) {tile_x, tile_y, name_index};
+    ctx.name_uses[name_index]++;
+
     set_tile_kind(tile_x, tile_y, TILE_CITY);
-            
-    // Creates the text label, loops through the pool instead of a dynamic array because it's small
-    for (int i = 0; i < TOTAL_LABELS; i++)
+    tile->city_id = city_id;
+
+    create_label(&city->label, ctx.font, 0);
+    set_label_content(&city->label, ctx.game.renderer, city_names[name_index]);
+
+    // Labels at the top right should be left-aligned
+    int x = tile->dest_rect.x + (tile_x > TILEMAP_WIDTH - 3 ? -city->label.sprite.transform.rect.w : 40);
+
+    set_transform_position(&city->label.sprite.transform, x, tile->dest_rect.y + 4);
+
+    // The capitals are created before they are captured, but the tile might belong to someone already
+    link_city(city_id, tile->owner_id);
+
+    // Pushing it to the front of its cell
+    int* cell = &ctx.city_grid[tile_y / CITY_GRID_CELL][tile_x / CITY_GRID_CELL];
+
+    ctx.next_city[city_id] = *cell;
+    *cell = city_id + 1;
+}
+
+void set_city_owner(int city_id, int previous_owner_id, int owner_id)
+{
+    city_t* city = &ctx.cities[city_id];
+
+    // Unlinking it, the neighbours point to each other instead
+    if (city->previous_owned)
+        ctx.cities[city->previous_owned - 1].next_owned = city->next_owned;
+    else
+        ctx.first_owned_city[previous_owner_id + 1] = city->next_owned;
+
+    if (city->next_owned)
+        ctx.cities[city->next_owned - 1].previous_owned = city->previous_owned;
+
+    link_city(city_id, owner_id);
+}
+
+void index_cities()
+{
+    memset(ctx.first_owned_city, 0, sizeof(ctx.first_owned_city));
+
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+        if (!(tile_kinds[tile->kind].flags & TILE_IS_CITY)) continue;
+
+        city_t* city = &ctx.cities[tile->city_id];
+
+        city->tile_x = x;
+        city->tile_y = y;
+
+        link_city(tile->city_id, tile->owner_id);
+    }
+}
+
+void update_hovered_cities(int tile_x, int tile_y)
+{
+    int hovered[MAX_HOVERED_LABELS];
+    int total_hovered = 0;
+
+    // Same area as always: CITY_PREVIEW_OFFSET tiles to the left and above, one less to the right and below
+    int left = tile_x - CITY_PREVIEW_OFFSET_X, right = tile_x + CITY_PREVIEW_OFFSET_X - 1;
+    int top = tile_y - CITY_PREVIEW_OFFSET_Y, bottom = tile_y + CITY_PREVIEW_OFFSET_Y - 1;
+
+    // The cursor can be outside of the map, the area can still reach into it
+    int first_x = MAX(left, 0);
+    int last_x = MIN(right, TILEMAP_WIDTH - 1);
+    int first_y = MAX(top, 0);
+    int last_y = MIN(bottom, TILEMAP_HEIGHT - 1);
+
+    for (int cell_y = first_y / CITY_GRID_CELL; cell_y <= last_y / CITY_GRID_CELL; cell_y++)
     {
-        label_t* label = &ctx.city_labels[i];
+        for (int cell_x = first_x / CITY_GRID_CELL; cell_x <= last_x / CITY_GRID_CELL; cell_x++)
+        {
+            for (int city_id = ctx.city_grid[cell_y][cell_x] - 1; city_id >= 0; city_id = ctx.next_city[city_id] - 1)
+            {
+                const city_t* city = &ctx.cities[city_id];
+
+                if (city->tile_x >= left && city->tile_x <= right && city->tile_y >= top && city->tile_y <= bottom)
+                    hovered[total_hovered++] = city_id;
+            }
+        }
+    }
 
-        // Ignore it if it's already used
-        if (label->sprite.texture != NULL) continue;
+    // Most mouse movements stay around the same cities
+    if (total_hovered == ctx.total_active_cities && memcmp(hovered, ctx.active_cities, total_hovered * sizeof(int)) == 0)
+        return;
 
-        create_label(label, ctx.font, 0);
-        set_label_content(label, ctx.game.renderer, city_names[rand() % (sizeof(city_names) / CITY_NAME_LEN)]);
+    memcpy(ctx.active_cities, hovered, total_hovered * sizeof(int));
+    ctx.total_active_cities = total_hovered;
+}
 
-        // Labels at the top right should be left-aligned
-        int x = tile->dest_rect.x + (tile_x > TILEMAP_WIDTH - 3 ? -label->sprite.transform.rect.w : 40);
+int random_city_name()
+{
+    int least_uses = ctx.name_uses[0];
+    int total_least_used = 0;
 
-        set_transform_position(&label->sprite.transform, x, tile->dest_rect.y + 4);
+    for (int i = 0; i < TOTAL_CITY_NAMES; i++)
+    {
+        if (ctx.name_uses[i] < least_uses)
+        {
+            least_uses = ctx.name_uses[i];
+            total_least_used = 0;
+        }
+
+        if (ctx.name_uses[i] == least_uses)
+            total_least_used++;
+    }
 
-        tile->label_index = i;
+    // Always a single random number, so the names don't change how the rest of the game plays out
+    int choice = random_range(total_least_used);
 
-        break;
+    for (int i = 0; i < TOTAL_CITY_NAMES; i++)
+    {
+        if (ctx.name_uses[i] == least_uses && choice-- == 0)
+            return i;
     }
 
-    ctx.total_cities++;
+    return 0;
+}
+
+void reset_atlas_tint()
+{
+    SDL_SetTextureColorMod(ctx.atlas_texture, 255, 255, 255);
+    SDL_SetTextureAlphaMod(ctx.atlas_texture, 255);
+}
+
+void render_tile(tile_t* tile, SDL_Renderer* renderer, const camera_t* camera)
+{
+    if (!(tile_kinds[tile->kind].flags & TILE_HAS_SPRITE))
+        return;
+
+    SDL_Rect dest_rect = world_to_screen_rect(camera, &tile->dest_rect);
+
+    int tile_x = (tile - &ctx.tilemap[0][0]) % TILEMAP_WIDTH, tile_y = (tile - &ctx.tilemap[0][0]) / TILEMAP_WIDTH;
+    bool is_visible = is_tile_visible_to_viewer(tile_x, tile_y);
+
+    // The borders are tinted and they share the atlas with the tiles
+    reset_atlas_tint();
+
+    // The terrain under the fog is still known, only who owns it isn't
+    if (!is_visible)
+        SDL_SetTextureColorMod(ctx.atlas_texture, FOG_BRIGHTNESS, FOG_BRIGHTNESS, FOG_BRIGHTNESS);
+
+    SDL_RenderCopy(renderer, ctx.atlas_texture, &tile->source_rect, &dest_rect);
+
+    // Render the border if its conquered on top of the tile
+    if (is_visible && tile->owner_id >= 0 && tile_kinds[tile->kind].flags & TILE_SHOWS_OWNER)
+    {
+        SDL_Color* color = &player_colors[tile->owner_id];
+        
+        SDL_SetTextureColorMod(ctx.atlas_texture, color->r, color->g, color->b);
+        SDL_SetTextureAlphaMod(ctx.atlas_texture, color->a);
+        SDL_RenderCopy(renderer, ctx.atlas_texture, &ctx.border_region, &dest_rect);
+    }
 }
 
 bool is_water(int tile_x, int tile_y)
 {
     tile_t* tile = &ctx.tilemap[tile_y][tile_x];
 
-    // Creating a special function for these because I might want more water tiles later on
-    return tile->kind == TILE_WATER || tile->kind == TILE_FISH;
+    return tile_kinds[tile->kind].flags & TILE_IS_SEA;
 }
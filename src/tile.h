@@ -1,25 +1,61 @@
 #ifndef _TILE_H
 #define _TILE_H
 
+#include <stdint.h>
 #include <SDL2/SDL.h>
+#include "engine/camera.h"
+#include "engine/interface.h"
 
 // Forward decleration
 struct soldiers_t;
 
-// These must be in the same order as in the texture
+// What the rules check about a kind, the kinds themselves are listed in tile_kinds.def
 typedef enum
 {
-    TILE_GRASS,
-    TILE_FOREST,
-    TILE_COAST,
-    TILE_CITY,
-    TILE_PORT,
-    TILE_FARM,
-    TILE_BROKEN_FARM,
-    TILE_FISH,
-    TILE_WATER,
+    // Water is only the background of the map
+    TILE_HAS_SPRITE = 1 << 0,
+
+    // Owned tiles are drawn with the border of the owner
+    TILE_SHOWS_OWNER = 1 << 1,
+
+    // Captured when soldiers move next to it and nobody stands on it
+    TILE_CLAIMED_AROUND = 1 << 2,
+
+    // Soldiers can go to sea from here
+    TILE_LAUNCHES_SHIPS = 1 << 3,
+
+    TILE_IS_SEA = 1 << 4,
+    TILE_IS_CITY = 1 << 5,
+    TILE_IS_FARM = 1 << 6,
+} tile_flags_e;
+
+typedef enum
+{
+#define TILE_KIND(name, ...) TILE_##name,
+#include "tile_kinds.def"
+#undef TILE_KIND
+
+    NUM_TILE_KINDS,
 } tile_kind_e;
 
+// Map packs and the spectator stream store the kind in 4 bits
+_Static_assert(NUM_TILE_KINDS <= 16, "Too many tile kinds for map packs and the spectator stream");
+
+typedef struct
+{
+    char symbol;
+    uint8_t flags;
+    uint8_t captured_kind;
+    int16_t capture_coins;
+    int16_t income;
+
+    // Only the terrain, the minimap tints it with the owner
+    SDL_Color minimap_color;
+} tile_kind_t;
+
+// Indexed by tile_kind_e, so every check is a single lookup
+extern const tile_kind_t tile_kinds[NUM_TILE_KINDS];
+
 // A tile represents a hex inside the game grid, it can be water or occupied land
 typedef struct tile_t
 {
@@ -29,19 +65,62 @@ typedef struct tile_t
     tile_kind_e kind;
     bool is_capital;
 
-    // Index of city label in ctx.city_labels
-    int label_index;
+    // Index of the city in ctx.cities, only meaningful for cities
+    int city_id;
     
     // Again, left to -1 if unclaimed
     int owner_id;
     struct soldiers_t* soldiers;
 } tile_t;
 
+// Every city is registered in ctx.cities when it's created, the ids are handed out in creation order
+// Cities are never removed during a game, so the id is also the slot of the city and nothing has to be searched
+// A context that only loaded a state (like the one of the simulation thread) has the position and the owner lists,
+// the name, the label and the hover grid are left zeroed there since nothing draws them
+typedef struct
+{
+    int tile_x, tile_y;
+
+    // Index of its name in city_names (so that map packs can store it)
+    int name_index;
+
+    // Only drawn when the cursor is near the city
+    label_t label;
+
+    // The cities of a player are chained in both directions (id + 1, zero ends the chain) so captures don't search
+    // The owner itself is the one of the tile, this is just an index of it
+    int previous_owned, next_owned;
+} city_t;
+
+// Goes through the ids of the cities of a player, in no particular order (-1 goes through the neutral ones)
+#define OWNED_CITIES_FOREACH(player_id, city_id) \
+    for (int city_id = ctx.first_owned_city[(player_id) + 1] - 1; city_id >= 0; city_id = ctx.cities[city_id].next_owned - 1)
+
 void create_tile(int tile_x, int tile_y, tile_kind_e kind);
 
 void set_tile_kind(int tile_x, int tile_y, tile_kind_e kind);
-void create_city(int tile_x, int tile_y);
+void create_city(int tile_x, int tile_y, int name_index);
+
+// Moves the city between the lists of the owners, -1 is the list of the neutral cities
+void set_city_owner(int city_id, int previous_owner_id, int owner_id);
+
+// Registers the cities of a tilemap that was replaced at once (like loading a state) and chains them to their owners again
+// Only the position and the owner lists are filled, the rest of city_t belongs to the cities that were created with
+// create_city, so it's left as it is (zeroed in a context that never created them)
+void index_cities();
+
+// Prefers the names that are used the least, so they only repeat once every name is taken
+int random_city_name();
+
+// Shows the labels of the cities around the hovered tile, which can be outside of the map
+void update_hovered_cities(int tile_x, int tile_y);
 
 bool is_water(int tile_x, int tile_y);
 
+// Undoes the color and alpha of the borders, everything else is drawn untinted from the atlas
+void reset_atlas_tint();
+
+// Draws the tile and its border, the atlas is left tinted
+void render_tile(tile_t* tile, SDL_Renderer* renderer, const camera_t* camera);
+
 #endif
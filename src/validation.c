@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdarg.h>
+
+#include "validation.h"
+#include "context.h"
+#include "rules.h"
+#include "hex_utils.h"
+#include "engine/utils.h"
+
+bool is_validation_enabled = false;
+
+static void report_divergence(const char* after, const char* format, ...)
+{
+    char problem[200];
+
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(problem, sizeof(problem), format, arguments);
+    va_end(arguments);
+
+    printf("Validation failed after %s on turn %u: ", after, ctx.turn);
+    assert_panic(true, problem);
+}
+
+static void check_player_counter(const char* after, const char* counter, int player_id, unsigned int kept, unsigned int counted)
+{
+    // Printed as signed numbers, so that counters that went below zero are easy to spot
+    if (kept != counted)
+        report_divergence(after, "%s of player %d is %d but the map has %d", counter, player_id, (int) kept, (int) counted);
+}
+
+void validate_counters(const char* after)
+{
+    player_t counted[TOTAL_PLAYERS] = {0};
+    unsigned int total_cities = 0;
+
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+        unsigned int flags = tile_kinds[tile->kind].flags;
+
+        if (flags & TILE_IS_CITY)
+            total_cities++;
+
+        if (tile->soldiers && tile->soldiers->current_tile != tile)
+            report_divergence(after, "the stack of (%d, %d) thinks it's somewhere else", x, y);
+
+        if (tile->soldiers && tile->owner_id < 0)
+            report_divergence(after, "the stack of (%d, %d) is on a neutral tile", x, y);
+
+        if (tile->owner_id < 0) continue;
+
+        // Units belong to the owner of their tile, ships included
+        player_t* player = &counted[tile->owner_id];
+        player->total_territories++;
+
+        if (flags & TILE_IS_CITY)
+            player->total_cities++;
+
+        if (flags & TILE_IS_FARM)
+            player->total_farms++;
+
+        if (tile->soldiers && soldier_kinds[tile->soldiers->kind].flags & SOLDIER_HAS_UNITS)
+            player->total_units += tile->soldiers->units;
+    }
+
+    if (ctx.total_cities != total_cities)
+        report_divergence(after, "the map should have %u cities but it has %u", ctx.total_cities, total_cities);
+
+    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+    {
+        player_t* player = &ctx.players[player_id];
+
+        check_player_counter(after, "total_territories", player_id, player->total_territories, counted[player_id].total_territories);
+        check_player_counter(after, "total_units", player_id, player->total_units, counted[player_id].total_units);
+        check_player_counter(after, "total_cities", player_id, player->total_cities, counted[player_id].total_cities);
+        check_player_counter(after, "total_farms", player_id, player->total_farms, counted[player_id].total_farms);
+
+        // The list of the registry has to hold exactly the cities that the player owns
+        unsigned int listed_cities = 0;
+
+        OWNED_CITIES_FOREACH(player_id, city_id)
+        {
+            const city_t* city = &ctx.cities[city_id];
+
+            if (ctx.tilemap[city->tile_y][city->tile_x].owner_id != player_id)
+                report_divergence(after, "the city of (%d, %d) is listed for player %d but isn't his", city->tile_x, city->tile_y, player_id);
+
+            listed_cities++;
+        }
+
+        check_player_counter(after, "the city list", player_id, listed_cities, counted[player_id].total_cities);
+    }
+
+    // Whatever isn't owned has to be in the neutral list, so together the lists hold every city once
+    unsigned int listed_cities = 0;
+
+    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+        listed_cities += counted[player_id].total_cities;
+
+    OWNED_CITIES_FOREACH(-1, city_id)
+    {
+        const city_t* city = &ctx.cities[city_id];
+
+        if (ctx.tilemap[city->tile_y][city->tile_x].owner_id != -1)
+            report_divergence(after, "the city of (%d, %d) is listed as neutral but it's owned", city->tile_x, city->tile_y);
+
+        listed_cities++;
+    }
+
+    if (listed_cities != ctx.total_cities)
+        report_divergence(after, "the lists of the owners hold %u cities but there are %u", listed_cities, ctx.total_cities);
+
+    // The income of the others is from their own turn, only the current one has to be up to date
+    player_t* current_player = &ctx.players[ctx.current_player_id];
+    int income = calculate_income(current_player);
+
+    if (current_player->income != income)
+        report_divergence(after, "the income of player %d is %d but it should be %d", ctx.current_player_id, current_player->income, income);
+}
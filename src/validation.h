@@ -0,0 +1,18 @@
+#ifndef _VALIDATION_H
+#define _VALIDATION_H
+
+#include <stdbool.h>
+
+/*
+ * A debug mode for the counters that the rules keep up to date by hand (territories, units, cities, farms and income)
+ * Every counter is counted again from the map and the first one that doesn't match stops the game with a report
+ * It goes through the whole map, so it's only turned on with --validate
+ */
+
+// Set once at startup, every thread of the tools reads it
+extern bool is_validation_enabled;
+
+// Panics at the first counter that is different from the map, after describes what happened before for the report
+void validate_counters(const char* after);
+
+#endif
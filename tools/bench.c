@@ -0,0 +1,429 @@
+#include <stdio.h>
+
+#include "context.h"
+#include "rules.h"
+#include "hex_utils.h"
+#include "savestate.h"
+#include "engine/utils.h"
+
+/*
+ * Micro-benchmarks of the hot functions of the rules and the map, for the map size it was built with (see make bench)
+ * Every result is printed as a line of JSON, so the lines of many runs can be compared with each other
+ * With a baseline, the benchmarks that got slower than the threshold are reported and the exit code is 1
+ */
+
+// Every round runs for at least this long, the fastest of the rounds is the result
+#define MIN_ROUND_SECONDS 0.1
+#define TOTAL_ROUNDS 5
+
+#define MAX_BASELINE_RESULTS 256
+
+typedef struct
+{
+    const char* name;
+
+    // Runs the operation total_ops times and returns the performance counter ticks that it took
+    // Anything that resets the state between operations is not counted
+    uint64_t (*run)(int total_ops);
+} benchmark_t;
+
+typedef struct
+{
+    char name[64];
+    char map[16];
+    double ns_per_op;
+} bench_result_t;
+
+// Written so that the compiler can't drop the results
+static volatile double sink;
+
+// The position that the benchmarks of the rules start from, restored between operations
+static savestate_t* arena;
+
+// The row of the stacks of the move benchmarks, the battle is right at the border of the two halves
+static int arena_y;
+
+static void place_stack(int tile_x, int tile_y, int units)
+{
+    soldiers_t* soldiers = create_soldiers(tile_x, tile_y, SOLDIER_KNIGHT);
+
+    set_soldier_units(soldiers, units);
+    soldiers->remaining_moves = soldier_kinds[SOLDIER_KNIGHT].moves;
+
+    ctx.players[ctx.tilemap[tile_y][tile_x].owner_id].total_units += units;
+}
+
+// Two players split a map of grass in half, both have cities, farms and an army on every fourth row
+static void build_arena()
+{
+    memset(&ctx, 0, sizeof(ctx));
+
+    ctx.starting_players = 2;
+    ctx.current_player_id = 0;
+    ctx.remaining_moves = MOVES_PER_TURN;
+    ctx.turn = 1;
+    set_map_seed(1);
+
+    MAP_FOREACH(x, y)
+        create_tile(x, y, TILE_GRASS);
+
+    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+        place_capital(player_id, player_id);
+
+    MAP_FOREACH(x, y)
+    {
+        tile_t* tile = &ctx.tilemap[y][x];
+        if (tile->is_capital) continue;
+
+        if (x % 5 == 2 && y % 6 == 0)
+            create_city(x, y, random_city_name());
+
+        capture_tile(x, y, x < TILEMAP_WIDTH / 2 ? 0 : 1);
+
+        if (x % 4 == 1 && y % 6 == 3)
+        {
+            set_tile_kind(x, y, TILE_FARM);
+            ctx.players[tile->owner_id].total_farms++;
+        }
+    }
+
+    // An even row, so that (x + 1, y + 1) is a neighbour of (x, y)
+    arena_y = TILEMAP_HEIGHT / 2 & ~1;
+
+    int border_x = TILEMAP_WIDTH / 2 - 1;
+
+    place_stack(1, arena_y, 60);
+    place_stack(border_x, arena_y, 100);
+    place_stack(border_x, arena_y - 2, 30);
+    place_stack(border_x + 1, arena_y + 1, 50);
+
+    MAP_FOREACH(x, y)
+    {
+        if (y % 4 == 1 && x % 2 == 0 && !ctx.tilemap[y][x].soldiers)
+            place_stack(x, y, 20);
+    }
+
+    for (int player_id = 0; player_id < ctx.starting_players; player_id++)
+        ctx.players[player_id].income = calculate_income(&ctx.players[player_id]);
+
+    save_state(arena);
+}
+
+static uint64_t bench_create_tilemap(int total_ops)
+{
+    uint64_t ticks = 0;
+
+    for (int i = 0; i < total_ops; i++)
+    {
+        free_game_state();
+        memset(&ctx, 0, sizeof(ctx));
+
+        ctx.starting_players = 2;
+        set_map_seed(i);
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        create_tilemap();
+        ticks += SDL_GetPerformanceCounter() - start;
+    }
+
+    free_game_state();
+    build_arena();
+
+    return ticks;
+}
+
+static uint64_t bench_noise(int total_ops)
+{
+    double sum = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    for (int i = 0; i < total_ops; i++)
+    {
+        int index = i % (TILEMAP_WIDTH * TILEMAP_HEIGHT);
+        sum += open_simplex_noise2(ctx.noise_context, index % TILEMAP_WIDTH / 8.0, index / TILEMAP_WIDTH / 8.0);
+    }
+
+    uint64_t ticks = SDL_GetPerformanceCounter() - start;
+    sink = sum;
+
+    return ticks;
+}
+
+static uint64_t bench_window_to_tile(int total_ops)
+{
+    create_camera(&ctx.camera, VIEWPORT_WIDTH, VIEWPORT_HEIGHT, TOTAL_TILEMAP_WIDTH, TOTAL_TILEMAP_HEIGHT);
+
+    // Zoomed in a bit and scrolled, so that the whole transform is used
+    zoom_camera_at(&ctx.camera, CAMERA_ZOOM_STEP, VIEWPORT_WIDTH / 2, VIEWPORT_HEIGHT / 2);
+
+    int valid = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    for (int i = 0; i < total_ops; i++)
+    {
+        int tile_x, tile_y;
+        valid += window_to_tile_position(&tile_x, &tile_y, i * 37 % VIEWPORT_WIDTH, i * 91 % VIEWPORT_HEIGHT);
+    }
+
+    uint64_t ticks = SDL_GetPerformanceCounter() - start;
+    sink = valid;
+
+    return ticks;
+}
+
+static uint64_t bench_is_neighbouring_tile(int total_ops)
+{
+    int neighbours = 0;
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    // Half of the destinations are neighbours, the rest are a bit further
+    for (int i = 0; i < total_ops; i++)
+        neighbours += is_neighbouring_tile(5, 10 + i % 2, 5 + i % 3 - 1, 10 + i % 7 - 3);
+
+    uint64_t ticks = SDL_GetPerformanceCounter() - start;
+    sink = neighbours;
+
+    return ticks;
+}
+
+static uint64_t run_arena_action(int total_ops, int source_x, int source_y, int tile_x, int tile_y)
+{
+    uint64_t ticks = 0;
+
+    for (int i = 0; i < total_ops; i++)
+    {
+        load_state(arena);
+        soldiers_t* soldiers = ctx.tilemap[source_y][source_x].soldiers;
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        move_soldiers(soldiers, tile_x, tile_y);
+        ticks += SDL_GetPerformanceCounter() - start;
+    }
+
+    return ticks;
+}
+
+// Onto an empty tile of the same player
+static uint64_t bench_move(int total_ops)
+{
+    return run_arena_action(total_ops, 1, arena_y, 1, arena_y + 2);
+}
+
+// Onto another stack of the same player two rows above
+static uint64_t bench_merge(int total_ops)
+{
+    return run_arena_action(total_ops, TILEMAP_WIDTH / 2 - 1, arena_y, TILEMAP_WIDTH / 2 - 1, arena_y - 2);
+}
+
+static uint64_t bench_battle(int total_ops)
+{
+    return run_arena_action(total_ops, TILEMAP_WIDTH / 2 - 1, arena_y, TILEMAP_WIDTH / 2, arena_y + 1);
+}
+
+// Goes through the tiles in order and hands them to the other player after every pass, so the counters stay right without a reset
+static uint64_t bench_capture_tile(int total_ops)
+{
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    for (int i = 0; i < total_ops; i++)
+    {
+        int index = i % (TILEMAP_WIDTH * TILEMAP_HEIGHT);
+        capture_tile(index % TILEMAP_WIDTH, index / TILEMAP_WIDTH, i / (TILEMAP_WIDTH * TILEMAP_HEIGHT) % 2);
+    }
+
+    uint64_t ticks = SDL_GetPerformanceCounter() - start;
+    load_state(arena);
+
+    return ticks;
+}
+
+static uint64_t bench_conquer_player(int total_ops)
+{
+    uint64_t ticks = 0;
+
+    for (int i = 0; i < total_ops; i++)
+    {
+        load_state(arena);
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        conquer_player(0, 1);
+        ticks += SDL_GetPerformanceCounter() - start;
+    }
+
+    return ticks;
+}
+
+static uint64_t bench_next_turn(int total_ops)
+{
+    uint64_t ticks = 0;
+
+    for (int i = 0; i < total_ops; i++)
+    {
+        load_state(arena);
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        next_turn();
+        ticks += SDL_GetPerformanceCounter() - start;
+    }
+
+    return ticks;
+}
+
+static const benchmark_t benchmarks[] = {
+    {"create_tilemap", bench_create_tilemap},
+    {"open_simplex_noise2", bench_noise},
+    {"window_to_tile_position", bench_window_to_tile},
+    {"is_neighbouring_tile", bench_is_neighbouring_tile},
+    {"move_soldiers/move", bench_move},
+    {"move_soldiers/merge", bench_merge},
+    {"move_soldiers/battle", bench_battle},
+    {"capture_tile", bench_capture_tile},
+    {"conquer_player", bench_conquer_player},
+    {"next_turn", bench_next_turn},
+};
+
+#define TOTAL_BENCHMARKS (int) (sizeof(benchmarks) / sizeof(benchmark_t))
+
+// Doubles the operations until a round takes long enough, then keeps the fastest round
+// The length of a round includes the resets, otherwise the benchmarks that reset the arena would run for ages
+static double measure(const benchmark_t* benchmark, int* total_ops)
+{
+    uint64_t min_ticks = MIN_ROUND_SECONDS * SDL_GetPerformanceFrequency();
+    *total_ops = 1;
+
+    for (;;)
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+        benchmark->run(*total_ops);
+
+        if (SDL_GetPerformanceCounter() - start >= min_ticks)
+            break;
+
+        *total_ops *= 2;
+    }
+
+    double best = 0;
+
+    for (int round = 0; round < TOTAL_ROUNDS; round++)
+    {
+        double ns = 1e9 * benchmark->run(*total_ops) / SDL_GetPerformanceFrequency() / *total_ops;
+
+        if (round == 0 || ns < best)
+            best = ns;
+    }
+
+    return best;
+}
+
+// Only reads the lines that this tool writes, anything else is skipped
+static int read_baseline(const char* path, bench_result_t* results)
+{
+    FILE* file = fopen(path, "r");
+    assert_panic(!file, "Couldn't open the baseline");
+
+    char line[256];
+    int total_results = 0;
+
+    while (fgets(line, sizeof(line), file) && total_results < MAX_BASELINE_RESULTS)
+    {
+        bench_result_t* result = &results[total_results];
+
+        if (sscanf(line, "{\"benchmark\": \"%63[^\"]\", \"map\": \"%15[^\"]\", \"ns_per_op\": %lf",
+            result->name, result->map, &result->ns_per_op) == 3)
+            total_results++;
+    }
+
+    fclose(file);
+    return total_results;
+}
+
+static const bench_result_t* find_result(const bench_result_t* results, int total_results, const char* name, const char* map)
+{
+    for (int i = 0; i < total_results; i++)
+    {
+        if (strcmp(results[i].name, name) == 0 && strcmp(results[i].map, map) == 0)
+            return &results[i];
+    }
+
+    return NULL;
+}
+
+static void display_help_and_exit()
+{
+    fprintf(stderr,
+        "Runs the micro-benchmarks and prints a line of JSON for each one:\n"
+        "   ./bench_[width]x[height] [options]\n\n"
+        "   OPTIONS:     --baseline [file]        compares the results with the lines of an older run\n"
+        "                --threshold [int]        percent that a benchmark may get slower before it's a regression (default 25)\n"
+        "                --only [name]            runs only the benchmarks whose name starts with this\n\n"
+        "   NOTES:       make bench runs every map size and compares them with bench_baseline.jsonl\n"
+    );
+
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv)
+{
+    const char* baseline_path = NULL;
+    const char* only = "";
+    int threshold = 25;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+            display_help_and_exit();
+
+        if (strcmp(argv[i], "--baseline") == 0)
+            baseline_path = argv[++i];
+
+        else if (strcmp(argv[i], "--threshold") == 0)
+            threshold = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--only") == 0)
+            only = argv[++i];
+
+        else
+            display_help_and_exit();
+    }
+
+    static bench_result_t baseline[MAX_BASELINE_RESULTS];
+    int total_baseline = baseline_path ? read_baseline(baseline_path, baseline) : 0;
+
+    char map[16];
+    sprintf(map, "%dx%d", TILEMAP_WIDTH, TILEMAP_HEIGHT);
+
+    arena = malloc(sizeof(savestate_t));
+    build_arena();
+
+    int total_regressions = 0;
+
+    for (int i = 0; i < TOTAL_BENCHMARKS; i++)
+    {
+        const benchmark_t* benchmark = &benchmarks[i];
+        if (strncmp(benchmark->name, only, strlen(only)) != 0) continue;
+
+        int total_ops;
+        double ns = measure(benchmark, &total_ops);
+
+        printf("{\"benchmark\": \"%s\", \"map\": \"%s\", \"ns_per_op\": %.1f, \"ops\": %d}\n", benchmark->name, map, ns, total_ops);
+        fflush(stdout);
+
+        // The report goes to stderr so that stdout stays valid JSON lines
+        const bench_result_t* old = find_result(baseline, total_baseline, benchmark->name, map);
+
+        if (old && ns > old->ns_per_op * (100 + threshold) / 100)
+        {
+            fprintf(stderr, "REGRESSION %-24s %-7s %10.1f ns, baseline %10.1f ns (%+.0f%%)\n",
+                benchmark->name, map, ns, old->ns_per_op, 100 * (ns / old->ns_per_op - 1));
+
+            total_regressions++;
+        }
+        else if (baseline_path && !old)
+            fprintf(stderr, "%s on %s isn't in the baseline\n", benchmark->name, map);
+    }
+
+    free_game_state();
+    free(arena);
+
+    return total_regressions > 0;
+}
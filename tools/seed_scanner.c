@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <stdatomic.h>
+
+#include "context.h"
+#include "rules.h"
+#include "hex_utils.h"
+#include "map_pack.h"
+#include "engine/utils.h"
+#include "engine/thread_pool.h"
+
+/*
+ * Generates the maps of lots of seeds and measures how fair the starting positions are
+ * A map is fair when every capital has about the same land, neutral cities, ports and distance to the enemy
+ * The fairest seeds are written to a sorted index, run it without arguments for the options
+ */
+
+// Tasks are blocks of seeds, so that the whole 32-bit range still fits in an int of tasks
+#define SEEDS_PER_TASK 4096
+#define UNREACHABLE 255
+
+typedef struct
+{
+    int seed;
+
+    // Sum of the relative spreads of every metric between the players, 0 is perfectly fair
+    float unfairness;
+
+    // Land tiles that the player reaches before anyone else and neutral cities within scanner->city_moves
+    unsigned short land[TOTAL_PLAYERS];
+    unsigned char cities[TOTAL_PLAYERS];
+
+    // In moves, UNREACHABLE if there is no port
+    unsigned char port_moves[TOTAL_PLAYERS];
+    unsigned char enemy_moves[TOTAL_PLAYERS];
+} seed_report_t;
+
+// Every thread keeps its own sorted list of the fairest seeds, they are merged at the end
+typedef struct
+{
+    seed_report_t* reports;
+    int total;
+} fair_seeds_t;
+
+typedef struct
+{
+    int players;
+    int64_t first_seed;
+    int64_t total_seeds;
+    unsigned int city_moves;
+    int top;
+
+    fair_seeds_t* threads;
+
+    atomic_int finished_tasks;
+    int total_tasks;
+} scanner_t;
+
+// The hex layout never changes, so the tiles that can be reached with one move are listed once for every tile
+typedef struct
+{
+    short targets[TOTAL_HIGHLIGHTED];
+    int total;
+} move_targets_t;
+
+static move_targets_t move_targets[TILEMAP_WIDTH * TILEMAP_HEIGHT];
+
+static void find_move_targets()
+{
+    MAP_FOREACH(x, y)
+    {
+        move_targets_t* tile = &move_targets[y * TILEMAP_WIDTH + x];
+
+        FOREACH_OFFSET(y, TOTAL_HIGHLIGHTED, i)
+        {
+            int target_x = x + highlighted_offsets[i][0];
+            int target_y = y + highlighted_offsets[i][1];
+
+            if (is_valid_tile(target_x, target_y))
+                tile->targets[tile->total++] = target_y * TILEMAP_WIDTH + target_x;
+        }
+    }
+}
+
+// Moves needed to reach every tile from a capital, soldiers can only go to the sea from ports (see move_soldiers)
+static void find_move_distances(int start, const bool* is_sea, const bool* can_sail, unsigned char* distances)
+{
+    short queue[TILEMAP_WIDTH * TILEMAP_HEIGHT];
+    int head = 0, tail = 0;
+
+    memset(distances, UNREACHABLE, TILEMAP_WIDTH * TILEMAP_HEIGHT);
+
+    distances[start] = 0;
+    queue[tail++] = start;
+
+    while (head < tail)
+    {
+        int tile = queue[head++];
+        move_targets_t* targets = &move_targets[tile];
+
+        for (int i = 0; i < targets->total; i++)
+        {
+            int target = targets->targets[i];
+
+            if (distances[target] != UNREACHABLE || (is_sea[target] && !can_sail[tile])) continue;
+
+            distances[target] = distances[tile] < UNREACHABLE - 1 ? distances[tile] + 1 : UNREACHABLE - 1;
+            queue[tail++] = target;
+        }
+    }
+}
+
+// How different the values of the players are, relative to the biggest one
+static float get_spread(const int* values, int total)
+{
+    int min = values[0], max = values[0];
+
+    for (int i = 1; i < total; i++)
+    {
+        if (values[i] < min) min = values[i];
+        if (values[i] > max) max = values[i];
+    }
+
+    return (float) (max - min) / (max + 1);
+}
+
+// Returns false if a player can't reach any enemy, those maps are never fair
+static bool analyze_map(scanner_t* scanner, seed_report_t* report)
+{
+    bool is_sea[TILEMAP_WIDTH * TILEMAP_HEIGHT], can_sail[TILEMAP_WIDTH * TILEMAP_HEIGHT];
+    unsigned char distances[TOTAL_PLAYERS][TILEMAP_WIDTH * TILEMAP_HEIGHT];
+
+    int land[TOTAL_PLAYERS] = {0}, cities[TOTAL_PLAYERS] = {0};
+    int port_moves[TOTAL_PLAYERS], enemy_moves[TOTAL_PLAYERS];
+
+    MAP_FOREACH(x, y)
+    {
+        is_sea[y * TILEMAP_WIDTH + x] = is_water(x, y);
+        can_sail[y * TILEMAP_WIDTH + x] = is_water(x, y) || tile_kinds[ctx.tilemap[y][x].kind].flags & TILE_LAUNCHES_SHIPS;
+    }
+
+    for (int player_id = 0; player_id < scanner->players; player_id++)
+    {
+        int capital = capital_positions[player_id][1] * TILEMAP_WIDTH + capital_positions[player_id][0];
+        find_move_distances(capital, is_sea, can_sail, distances[player_id]);
+    }
+
+    for (int player_id = 0; player_id < scanner->players; player_id++)
+    {
+        unsigned char* own_distances = distances[player_id];
+
+        port_moves[player_id] = UNREACHABLE;
+        enemy_moves[player_id] = UNREACHABLE;
+
+        for (int enemy_id = 0; enemy_id < scanner->players; enemy_id++)
+        {
+            int enemy_capital = capital_positions[enemy_id][1] * TILEMAP_WIDTH + capital_positions[enemy_id][0];
+
+            if (enemy_id != player_id && own_distances[enemy_capital] < enemy_moves[player_id])
+                enemy_moves[player_id] = own_distances[enemy_capital];
+        }
+
+        if (enemy_moves[player_id] == UNREACHABLE) return false;
+
+        MAP_FOREACH(x, y)
+        {
+            tile_t* tile = &ctx.tilemap[y][x];
+            int moves = own_distances[y * TILEMAP_WIDTH + x];
+
+            if (tile->kind == TILE_PORT && moves < port_moves[player_id])
+                port_moves[player_id] = moves;
+
+            if (tile->kind == TILE_CITY && tile->owner_id < 0 && moves <= scanner->city_moves)
+                cities[player_id]++;
+
+            if (is_sea[y * TILEMAP_WIDTH + x]) continue;
+
+            // Land only counts for the player that gets there first
+            bool is_first = true;
+
+            for (int enemy_id = 0; enemy_id < scanner->players && is_first; enemy_id++)
+                is_first = enemy_id == player_id || moves < distances[enemy_id][y * TILEMAP_WIDTH + x];
+
+            if (is_first && moves != UNREACHABLE)
+                land[player_id]++;
+        }
+
+        report->land[player_id] = land[player_id];
+        report->cities[player_id] = cities[player_id];
+        report->port_moves[player_id] = port_moves[player_id];
+        report->enemy_moves[player_id] = enemy_moves[player_id];
+    }
+
+    report->unfairness = get_spread(land, scanner->players) + get_spread(cities, scanner->players)
+        + get_spread(port_moves, scanner->players) + get_spread(enemy_moves, scanner->players);
+
+    return true;
+}
+
+static int compare_reports(const void* a, const void* b)
+{
+    const seed_report_t* first = a;
+    const seed_report_t* second = b;
+
+    if (first->unfairness != second->unfairness)
+        return first->unfairness < second->unfairness ? -1 : 1;
+
+    return (first->seed > second->seed) - (first->seed < second->seed);
+}
+
+// Keeps the list sorted and at most scanner->top long, most seeds are worse than the last one so they stop right away
+static void add_fair_seed(scanner_t* scanner, fair_seeds_t* fair_seeds, const seed_report_t* report)
+{
+    if (fair_seeds->total == scanner->top && compare_reports(report, &fair_seeds->reports[fair_seeds->total - 1]) >= 0)
+        return;
+
+    int i = MIN(fair_seeds->total, scanner->top - 1);
+
+    for (; i > 0 && compare_reports(report, &fair_seeds->reports[i - 1]) < 0; i--)
+        fair_seeds->reports[i] = fair_seeds->reports[i - 1];
+
+    fair_seeds->reports[i] = *report;
+
+    if (fair_seeds->total < scanner->top)
+        fair_seeds->total++;
+}
+
+static void scan_seeds(int task_index, int thread_index, void* data)
+{
+    scanner_t* scanner = data;
+
+    int64_t first = scanner->first_seed + (int64_t) task_index * SEEDS_PER_TASK;
+    int64_t last = MIN(first + SEEDS_PER_TASK, scanner->first_seed + scanner->total_seeds);
+
+    for (int64_t seed = first; seed < last; seed++)
+    {
+        // Only the map is generated, exactly like when a game starts
+        memset(&ctx, 0, sizeof(ctx));
+
+        ctx.starting_players = scanner->players;
+        ctx.current_player_id = -1;
+        set_map_seed((int) seed);
+        create_tilemap();
+        generate_unclaimed_cities();
+
+        seed_report_t report = {(int) seed};
+
+        if (analyze_map(scanner, &report))
+            add_fair_seed(scanner, &scanner->threads[thread_index], &report);
+
+        free_game_state();
+    }
+
+    int finished = atomic_fetch_add(&scanner->finished_tasks, 1) + 1;
+
+    if (thread_index == 0)
+        fprintf(stderr, "\rScanned %.1f%% of the seeds", 100.0 * finished / scanner->total_tasks);
+}
+
+static void write_list(FILE* file, const void* values, bool is_short, int total)
+{
+    for (int i = 0; i < total; i++)
+    {
+        int value = is_short ? ((const unsigned short*) values)[i] : ((const unsigned char*) values)[i];
+        fprintf(file, i == 0 ? "%d" : ",%d", value);
+    }
+}
+
+static void write_index(scanner_t* scanner, const char* path, seed_report_t* reports, int total)
+{
+    FILE* file = fopen(path, "w");
+    assert_panic(!file, "Couldn't create the seed index");
+
+    fprintf(file, "# %d players, cities within %u moves, %d is unreachable\n", scanner->players, scanner->city_moves, UNREACHABLE);
+    fprintf(file, "# seed unfairness land cities port_moves enemy_moves\n");
+
+    for (int i = 0; i < total; i++)
+    {
+        seed_report_t* report = &reports[i];
+
+        fprintf(file, "%d %.4f ", report->seed, report->unfairness);
+        write_list(file, report->land, true, scanner->players);
+        fputc(' ', file);
+        write_list(file, report->cities, false, scanner->players);
+        fputc(' ', file);
+        write_list(file, report->port_moves, false, scanner->players);
+        fputc(' ', file);
+        write_list(file, report->enemy_moves, false, scanner->players);
+        fputc('\n', file);
+    }
+
+    fclose(file);
+}
+
+static void display_help_and_exit()
+{
+    printf(
+        "Generates the maps of many seeds and writes the fairest ones to a sorted index:\n"
+        "   ./seed_scanner [options]\n\n"
+        "   OPTIONS:     --players [int]          2-4 players (default 2)\n"
+        "                --seed [int]             the first seed (default 0)\n"
+        "                --count [int]            how many seeds to scan, 4294967296 is all of them (default 100000)\n"
+        "                --city-moves [int]       neutral cities within this many moves count for a player (default 6)\n"
+        "                --top [int]              how many seeds the index keeps (default 1000)\n"
+        "                --threads [int]          defaults to one per core\n"
+        "                --output [file]          where the index is written (default fair_seeds.txt)\n"
+        "                --pack [file]            also writes the maps of the index to a map pack for --map-pack\n\n"
+        "   NOTES:       seeds are ints, so the full range starts from --seed -2147483648\n"
+    );
+
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv)
+{
+    scanner_t scanner = {2, 0, 100000, 6, 1000};
+    const char* output = "fair_seeds.txt";
+    const char* pack_path = NULL;
+    int total_threads = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+            display_help_and_exit();
+
+        if (strcmp(argv[i], "--players") == 0)
+            scanner.players = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--seed") == 0)
+            scanner.first_seed = strtoll(argv[++i], NULL, 10);
+
+        else if (strcmp(argv[i], "--count") == 0)
+            scanner.total_seeds = strtoll(argv[++i], NULL, 10);
+
+        else if (strcmp(argv[i], "--city-moves") == 0)
+            scanner.city_moves = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--top") == 0)
+            scanner.top = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--threads") == 0)
+            total_threads = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--output") == 0)
+            output = argv[++i];
+
+        else if (strcmp(argv[i], "--pack") == 0)
+            pack_path = argv[++i];
+
+        else
+            display_help_and_exit();
+    }
+
+    // Seeds have to fit in an int, that's what set_map_seed takes
+    if (scanner.players < 2 || scanner.players > TOTAL_PLAYERS || scanner.total_seeds < 1 || scanner.top < 1
+        || scanner.first_seed < INT32_MIN || scanner.first_seed + scanner.total_seeds - 1 > INT32_MAX)
+        display_help_and_exit();
+
+    if (total_threads <= 0)
+        total_threads = get_default_thread_count();
+
+    scanner.threads = calloc(total_threads, sizeof(fair_seeds_t));
+
+    for (int i = 0; i < total_threads; i++)
+        scanner.threads[i].reports = malloc(scanner.top * sizeof(seed_report_t));
+
+    find_move_targets();
+
+    scanner.total_tasks = (scanner.total_seeds + SEEDS_PER_TASK - 1) / SEEDS_PER_TASK;
+    atomic_init(&scanner.finished_tasks, 0);
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    run_tasks_in_parallel(scanner.total_tasks, total_threads, scan_seeds, &scanner);
+    double seconds = (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    // Merging the lists of the threads
+    seed_report_t* reports = malloc((size_t) total_threads * scanner.top * sizeof(seed_report_t));
+    int total = 0;
+
+    for (int i = 0; i < total_threads; i++)
+    {
+        memcpy(&reports[total], scanner.threads[i].reports, scanner.threads[i].total * sizeof(seed_report_t));
+        total += scanner.threads[i].total;
+
+        free(scanner.threads[i].reports);
+    }
+
+    qsort(reports, total, sizeof(seed_report_t), compare_reports);
+    total = MIN(total, scanner.top);
+
+    write_index(&scanner, output, reports, total);
+
+    printf("\rScanned %lld seeds in %.2fs (%.0f seeds/sec on %d threads)\n",
+        (long long) scanner.total_seeds, seconds, scanner.total_seeds / seconds, total_threads);
+
+    if (total > 0)
+        printf("Wrote the %d fairest seeds to %s, the best one is %d with unfairness %.4f\n", total, output, reports[0].seed, reports[0].unfairness);
+
+    // The fairest map is the first one of the pack
+    if (pack_path)
+    {
+        int* seeds = malloc(total * sizeof(int));
+
+        for (int i = 0; i < total; i++)
+            seeds[i] = reports[i].seed;
+
+        write_map_pack(pack_path, seeds, total, scanner.players);
+        printf("Wrote their maps to %s\n", pack_path);
+
+        free(seeds);
+    }
+
+    free(reports);
+    free(scanner.threads);
+
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <math.h>
+
+#include "context.h"
+#include "rules.h"
+#include "bots.h"
+#include "validation.h"
+#include "engine/thread_pool.h"
+
+/*
+ * Plays lots of seeded games between bots to see how the constants of context.h change the balance
+ * Every thread has its own context (see THREAD_LOCAL_CONTEXT) and the games are spread with work stealing
+ * Run it without arguments for the options
+ */
+
+typedef struct
+{
+    // Index in the bot list, -1 if the turn limit was reached
+    int winner;
+    unsigned int turns;
+} game_result_t;
+
+typedef struct
+{
+    bot_kind_e bots[TOTAL_PLAYERS];
+    int total_bots;
+
+    int total_games;
+    unsigned int max_turns;
+    int first_seed;
+
+    game_result_t* results;
+} tournament_t;
+
+static void play_game(int game_index, int thread_index, void* data)
+{
+    tournament_t* tournament = data;
+
+    // Threads reuse their context between games
+    memset(&ctx, 0, sizeof(ctx));
+
+    ctx.starting_players = tournament->total_bots;
+    set_map_seed(tournament->first_seed + game_index);
+    start_game();
+
+    if (is_validation_enabled)
+        validate_counters("the start of the game");
+
+    // Rotating the seats so that every bot plays from every corner
+    uint32_t random_state = ((uint32_t) game_index * 2654435761u) | 1;
+    int rotation = game_index % tournament->total_bots;
+
+    while (find_winner() < 0 && ctx.turn < tournament->max_turns)
+    {
+        int bot_index = (ctx.current_player_id + rotation) % tournament->total_bots;
+        play_bot_turn(tournament->bots[bot_index], &random_state);
+    }
+
+    int winner = find_winner();
+
+    tournament->results[game_index] = (game_result_t) {
+        winner < 0 ? -1 : (winner + rotation) % tournament->total_bots,
+        ctx.turn,
+    };
+
+    free_game_state();
+}
+
+// 95% Wilson score interval, it behaves well even for win rates close to 0 or 1
+static void get_confidence_interval(int wins, int games, double* low, double* high)
+{
+    const double z = 1.96;
+
+    double rate = (double) wins / games;
+    double denominator = 1 + z * z / games;
+    double center = (rate + z * z / (2 * games)) / denominator;
+    double margin = z * sqrt(rate * (1 - rate) / games + z * z / (4.0 * games * games)) / denominator;
+
+    // Rounding can put the bounds a hair outside of the possible rates, which prints as -0.0%
+    *low = fmax(center - margin, 0);
+    *high = fmin(center + margin, 1);
+}
+
+static void display_help_and_exit()
+{
+    printf(
+        "Plays seeded games between bots and reports how often each one wins:\n"
+        "   ./tournament [options]\n\n"
+        "   OPTIONS:     --bots [names]           2-4 comma separated bots from random, greedy and search (default greedy,random)\n"
+        "                --games [int]            how many games to play (default 1000)\n"
+        "                --threads [int]          defaults to one per core\n"
+        "                --max-turns [int]        games that last longer are draws (default 400)\n"
+        "                --seed [int]             the map seed of the first game, the rest follow it (default 1)\n"
+        "                --validate               counts every counter of the rules again after each action (slow)\n\n"
+        "   NOTES:       balance constants can be changed when building, e.g. make tournament BALANCE=\"-DFARM_INCOME=5\"\n"
+    );
+
+    exit(EXIT_FAILURE);
+}
+
+static void parse_bots(tournament_t* tournament, char* list)
+{
+    for (char* name = strtok(list, ","); name; name = strtok(NULL, ","))
+    {
+        int kind = find_bot_kind(name);
+
+        if (kind < 0 || tournament->total_bots == TOTAL_PLAYERS)
+            display_help_and_exit();
+
+        tournament->bots[tournament->total_bots++] = kind;
+    }
+
+    if (tournament->total_bots < 2)
+        display_help_and_exit();
+}
+
+int main(int argc, char** argv)
+{
+    tournament_t tournament = {{BOT_GREEDY, BOT_RANDOM}, 2, 1000, 400, 1};
+    int total_threads = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        // The only option without a value
+        if (strcmp(argv[i], "--validate") == 0)
+        {
+            is_validation_enabled = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+            display_help_and_exit();
+
+        if (strcmp(argv[i], "--bots") == 0)
+        {
+            tournament.total_bots = 0;
+            parse_bots(&tournament, argv[++i]);
+        }
+        else if (strcmp(argv[i], "--games") == 0)
+            tournament.total_games = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--threads") == 0)
+            total_threads = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--max-turns") == 0)
+            tournament.max_turns = atoi(argv[++i]);
+
+        else if (strcmp(argv[i], "--seed") == 0)
+            tournament.first_seed = atoi(argv[++i]);
+
+        else
+            display_help_and_exit();
+    }
+
+    if (tournament.total_games < 1)
+        display_help_and_exit();
+
+    if (total_threads <= 0)
+        total_threads = get_default_thread_count();
+
+    tournament.results = calloc(tournament.total_games, sizeof(game_result_t));
+
+    uint64_t start = SDL_GetPerformanceCounter();
+    run_tasks_in_parallel(tournament.total_games, total_threads, play_game, &tournament);
+    double seconds = (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    // Collecting the results
+    int wins[TOTAL_PLAYERS] = {0};
+    int draws = 0;
+    double total_turns = 0;
+
+    for (int i = 0; i < tournament.total_games; i++)
+    {
+        game_result_t* result = &tournament.results[i];
+
+        if (result->winner < 0)
+            draws++;
+        else
+            wins[result->winner]++;
+
+        total_turns += result->turns;
+    }
+
+    printf("Played %d games in %.2fs (%.1f games/sec on %d threads)\n",
+        tournament.total_games, seconds, tournament.total_games / seconds, total_threads);
+
+    printf("Average game length: %.1f turns, draws after %u turns: %d\n\n",
+        total_turns / tournament.total_games, tournament.max_turns, draws);
+
+    // The seats are rotated every game, so the rows are the bots in the order of --bots
+    printf("%-4s %-8s %8s %10s   %s\n", "bot", "name", "wins", "win rate", "95% confidence");
+
+    for (int i = 0; i < tournament.total_bots; i++)
+    {
+        double low, high;
+        get_confidence_interval(wins[i], tournament.total_games, &low, &high);
+
+        printf("%-4d %-8s %8d %9.1f%%   [%.1f%%, %.1f%%]\n", i + 1, bot_names[tournament.bots[i]], wins[i],
+            100.0 * wins[i] / tournament.total_games, 100 * low, 100 * high);
+    }
+
+    free(tournament.results);
+
+    return 0;
+}